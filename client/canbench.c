@@ -0,0 +1,312 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * canbench: host benchmark of the firmware CAN ID dispatch
+ * 	(vehicle_xx_poll0/poll1 switch chains vs vehicle_can_lookup tables)
+ *
+ * Dispatches the CAN IDs of the Tesla Roadster, Kia Soul (poll1) and
+ * Renault Twizy modules through:
+ *  switch   the compare chain C18 generates for a switch on can_id
+ *           (one 16 bit compare per case, in case order)
+ *  bsearch  binary search in the vehicle_canid_t table + handler table
+ *           call (the former vehicle_can_lookup)
+ *  filter   ECAN filter hit as table index + handler table call
+ *           (only possible if every ID has its own filter)
+ *  twizy    Twizy scheme: switch on the filter hit, then on can_id
+ *
+ * With the small ID sets of our vehicles the switch compare chain wins
+ * on the PIC: by the cycle model a binary search only pays off above
+ * ~130 IDs per handler.
+ *
+ * Reports compares per frame, host ns per frame and a rough PIC18 cycle
+ * estimate. The cycle model assumes 4 cycles per switch case tried,
+ * 36 per binary search step (rom table read + 16 bit compare), 20 for
+ * the lookup call, 8 for the filter hit check and 22 for the indirect
+ * handler call (estimated for C18 output, not measured on target).
+ *
+ * Usage:
+ *  ./canbench [iterations]
+ *
+ * Build:
+ *  gcc -O2 -o canbench canbench.c
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define CYC_CASE    4
+#define CYC_STEP    36
+#define CYC_LOOKUP  20
+#define CYC_FILTER  8
+#define CYC_CALL    22
+
+typedef struct
+{
+  unsigned char rxb;          // receive buffer: 0 / 1
+  unsigned int id;
+} vehicle_canid_t;
+
+typedef struct
+{
+  const char *name;
+  const vehicle_canid_t *ids; // sorted by ID (dispatch table)
+  int n;
+  const unsigned int *cases;  // switch case order in the module
+  const unsigned char *filter;// filter hit per case order entry
+} vehicle_t;
+
+// (IDs from vehicle/OVMS.X/vehicle_teslaroadster.c)
+const vehicle_canid_t tr_ids[] =
+  { { 0, 0x100 }, { 0, 0x102 }, { 1, 0x344 }, { 1, 0x400 }, { 1, 0x402 } };
+const unsigned int tr_cases[] = { 0x100, 0x102, 0x344, 0x400, 0x402 };
+const unsigned char tr_filter[] = { 0, 1, 2, 3, 4 };
+
+// (IDs from vehicle/OVMS.X/vehicle_kiasoul.c, vehicle_kiasoul_poll1)
+const vehicle_canid_t ks_ids[] =
+  { { 1, 0x018 }, { 1, 0x120 }, { 1, 0x200 }, { 1, 0x433 }, { 1, 0x4f0 },
+    { 1, 0x4f2 }, { 1, 0x542 }, { 1, 0x581 }, { 1, 0x594 }, { 1, 0x653 } };
+const unsigned int ks_cases[] = { 0x018, 0x120, 0x200, 0x433, 0x4f0,
+    0x4f2, 0x542, 0x581, 0x594, 0x653 };
+const unsigned char ks_filter[] = { 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 };
+
+// (IDs from vehicle/OVMS.X/vehicle_twizy.c, vehicle_twizy_poll0/1,
+//  grouped by ECAN filter hit)
+const vehicle_canid_t tw_ids[] =
+  { { 1, 0x081 }, { 0, 0x155 }, { 1, 0x196 }, { 0, 0x424 }, { 0, 0x554 },
+    { 0, 0x556 }, { 0, 0x557 }, { 0, 0x55E }, { 0, 0x55F }, { 1, 0x581 },
+    { 1, 0x597 }, { 1, 0x599 }, { 1, 0x59B }, { 1, 0x59E }, { 1, 0x5D7 },
+    { 1, 0x69F } };
+const unsigned int tw_cases[] = { 0x155, 0x556, 0x554, 0x557, 0x55E, 0x55F,
+    0x424, 0x196, 0x081, 0x581, 0x597, 0x599, 0x59B, 0x59E, 0x69F, 0x5D7 };
+const unsigned char tw_filter[] = { 0, 1, 1, 1, 1, 1,
+    1, 2, 2, 3, 3, 4, 4, 4, 4, 5 };
+
+const vehicle_t vehicles[] =
+  {
+  { "Roadster", tr_ids, 5, tr_cases, tr_filter },
+  { "Kia poll1", ks_ids, 10, ks_cases, ks_filter },
+  { "Twizy", tw_ids, 16, tw_cases, tw_filter },
+  { NULL, NULL, 0, NULL, NULL }
+  };
+
+unsigned int can_id;
+unsigned char can_filter;
+unsigned char fltidx[6];      // filter hit -> table index (0xff = shared)
+long compares;
+long cycles;
+volatile long handled;
+
+int handler(void) { handled++; return 1; }
+int (*handlers[16])(void);
+
+// switch on can_id: compare chain in case order
+int dispatch_switch(const vehicle_t *v)
+{
+  int k;
+
+  for (k = 0; k < v->n; k++)
+  {
+    compares++;
+    cycles += CYC_CASE;
+    if (v->cases[k] == can_id)
+      return handler();
+  }
+  return 0;
+}
+
+// Twizy: switch on the filter hit, then on can_id within the group
+int dispatch_twizy(const vehicle_t *v)
+{
+  int k;
+
+  for (k = 0; k < v->n; k++)
+  {
+    if (k == 0 || v->filter[k] != v->filter[k-1])
+    {
+      compares++;
+      cycles += CYC_CASE;
+    }
+    if (v->filter[k] != can_filter)
+      continue;
+    compares++;
+    cycles += CYC_CASE;
+    if (v->cases[k] == can_id)
+      return handler();
+  }
+  return 0;
+}
+
+// (former vehicle/OVMS.X/vehicle.c vehicle_can_lookup + filter hit variant)
+unsigned char vehicle_can_lookup(const vehicle_canid_t *list, unsigned char n,
+  int usefilter)
+{
+  unsigned char lo, hi, mid;
+
+  cycles += CYC_LOOKUP;
+  if (usefilter && can_filter < 6 && fltidx[can_filter] != 0xff)
+  {
+    cycles += CYC_FILTER;
+    compares++;
+    if (list[fltidx[can_filter]].id == can_id)
+      return fltidx[can_filter];
+  }
+
+  lo = 0;
+  hi = n;
+  while (lo < hi)
+  {
+    mid = (lo + hi) >> 1;
+    compares++;
+    cycles += CYC_STEP;
+    if (list[mid].id == can_id)
+      return mid;
+    else if (list[mid].id < can_id)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return 0xff;
+}
+
+int dispatch_table(const vehicle_t *v, int usefilter)
+{
+  unsigned char k;
+
+  k = vehicle_can_lookup(v->ids, v->n, usefilter);
+  if (k == 0xff)
+    return 0;
+  cycles += CYC_CALL;
+  return (*handlers[k])();
+}
+
+int dispatch(int mode, const vehicle_t *v)
+{
+  switch (mode)
+  {
+    case 0: return dispatch_switch(v);
+    case 1: return dispatch_table(v, 0);
+    case 2: return dispatch_table(v, 1);
+    default: return dispatch_twizy(v);
+  }
+}
+
+// Filter hit map as vehicle_can_setfilters builds it: one filter per ID
+// if the buffer has enough filters, else shared (0xff)
+int setfilters(const vehicle_t *v)
+{
+  int cnt[2] = { 0, 0 }, k, b, exact = 1;
+
+  memset(fltidx, 0xff, sizeof(fltidx));
+  for (k = 0; k < v->n; k++)
+    cnt[v->ids[k].rxb]++;
+  for (b = 0; b < 2; b++)
+    if (cnt[b] > (b ? 4 : 2))
+      exact = 0;
+  if (!exact)
+    return 0;
+  cnt[0] = 0; cnt[1] = 2;
+  for (k = 0; k < v->n; k++)
+    fltidx[cnt[v->ids[k].rxb]++] = k;
+  return 1;
+}
+
+// Set can_id / can_filter for frame i (all IDs in turn, equal rates)
+void frame(const vehicle_t *v, int i)
+{
+  int k;
+
+  can_id = v->cases[i % v->n];
+  can_filter = v->filter[i % v->n];
+  for (k = 0; k < 6; k++)
+    if (fltidx[k] != 0xff && v->ids[fltidx[k]].id == can_id)
+      can_filter = k;
+}
+
+double bench(int mode, const vehicle_t *v, long n)
+{
+  clock_t t0, t1;
+  long i;
+
+  t0 = clock();
+  for (i = 0; i < n; i++)
+  {
+    frame(v, i);
+    dispatch(mode, v);
+  }
+  t1 = clock();
+  if (t1 == t0)
+    t1++;
+  return (double) (t1 - t0) * 1e9 / CLOCKS_PER_SEC / n;
+}
+
+int main(int argc, char *argv[])
+{
+  long n = (argc > 1) ? atol(argv[1]) : 10000000;
+  const char *modes[4] = { "switch", "bsearch", "filter", "twizy" };
+  const vehicle_t *v;
+  long c, y;
+  int i, m;
+
+  if (n <= 0)
+  {
+    fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  for (i = 0; i < 16; i++)
+    handlers[i] = handler;
+
+  printf("%-10s %-8s %8s %8s %8s\n", "vehicle", "dispatch",
+    "cmp/frm", "ns/frm", "cyc/frm");
+  for (v = vehicles; v->name != NULL; v++)
+  {
+    setfilters(v);
+    for (m = 0; m < 4; m++)
+    {
+      if (m == 2 && fltidx[0] == 0xff)
+        continue;   // filter hit index needs one filter per ID
+      if (m == 3 && v->filter != tw_filter)
+        continue;
+      compares = cycles = 0;
+      for (i = 0; i < v->n; i++)
+      {
+        frame(v, i);
+        if (!dispatch(m, v))
+        {
+          fprintf(stderr, "ERROR: %s %s: ID 0x%03x not dispatched\n",
+            v->name, modes[m], can_id);
+          return 2;
+        }
+      }
+      c = compares;
+      y = cycles;
+      printf("%-10s %-8s %8.2f %8.1f %8.1f\n", v->name, modes[m],
+        (double) c / v->n, bench(m, v, n), (double) y / v->n);
+    }
+  }
+  return 0;
+}
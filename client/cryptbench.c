@@ -0,0 +1,477 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * cryptbench: host benchmark of the firmware message encryption
+ * 	(RC4 + base64 as done by net_msg_encode_puts and net_msg_in, normal &
+ * 	paranoid mode)
+ *
+ * Compares paranoid mode encoding with a new RC4 setup and 1KB discard per
+ * message against reusing the primed state (restored by RC4_rewind), and
+ * checks both produce the same output.
+ *
+ * Compares +IPD line framing from the RX ring per character against the
+ * line block reads of UARTIntGetBlock, including base64 + RC4 decoding.
+ *
+ * See msgbench for the message composition, CRC16, binary record and
+ * parameter access benchmarks.
+ *
+ * Usage:
+ *  ./cryptbench [iterations]
+ *
+ * Build:
+ *  gcc -O2 -o cryptbench cryptbench.c
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+// RC4 from the firmware:
+#include "../vehicle/OVMS.X/crypt_rc4.c"
+
+
+
+/*******************************************************************************
+ * base64 encode
+ *
+ * (copied from vehicle/OVMS.X/crypt_base64.c)
+ *
+ */
+
+static const unsigned char cb64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void encodeblock( unsigned char in[3], unsigned char out[4], int len )
+{
+  out[0] = cb64[ in[0] >> 2 ];
+  out[1] = cb64[ ((in[0] & 0x03) << 4) | ((in[1] & 0xf0) >> 4) ];
+  out[2] = (unsigned char) (len > 1 ? cb64[ ((in[1] & 0x0f) << 2) | ((in[2] & 0xc0) >> 6) ] : '=');
+  out[3] = (unsigned char) (len > 2 ? cb64[ in[2] & 0x3f ] : '=');
+}
+
+char *base64encode(unsigned char *inputData, int inputLen, unsigned char *outputData)
+{
+  int len, i;
+  unsigned char in[3];
+
+  while (inputLen > 0)
+  {
+    for (len = 0, i = 0; i < 3; i++)
+    {
+      if (inputLen > 0)
+      {
+        in[i] = *inputData++;
+        len++;
+        inputLen--;
+      }
+      else
+        in[i] = 0;
+    }
+    encodeblock(in, outputData, len);
+    outputData += 4;
+  }
+  *outputData = 0;
+  return (char *) outputData;
+}
+
+
+/*******************************************************************************
+ * Message encoding (as net_msg_encode_puts)
+ *
+ */
+
+#define MD5_SIZE 16
+#define NET_BUF_MAX 200
+
+RC4_CTX1 tx_crypto1, pm_crypto1;
+RC4_CTX2 tx_crypto2, pm_crypto2;
+unsigned char pdigest[MD5_SIZE] = "0123456789abcdef";
+unsigned char txdigest[MD5_SIZE] = "fedcba9876543210";
+
+unsigned char scratchpad[NET_BUF_MAX];
+unsigned char msgbuf[NET_BUF_MAX];
+unsigned char outbuf[NET_BUF_MAX*2];
+
+const char *testmsg = "MP-0 S90,K,220,0,done,standard,260,245,12,0,0,0,13,1,0,0,0,0,0";
+
+void prime(RC4_CTX1 *ctx1, RC4_CTX2 *ctx2, unsigned char *key)
+{
+  int k;
+
+  RC4_setup(ctx1, ctx2, key, MD5_SIZE);
+  for (k=0;k<1024;k++)
+  {
+    scratchpad[0] = 0;
+    RC4_crypt(ctx1, ctx2, scratchpad, 1);
+  }
+}
+
+void txencode(void)
+{
+  int k = strlen((char *) scratchpad);
+  RC4_crypt(&tx_crypto1, &tx_crypto2, scratchpad, k);
+  base64encode(scratchpad, k, outbuf);
+}
+
+void encode_normal(void)
+{
+  strcpy((char *) scratchpad, testmsg);
+  txencode();
+}
+
+// mode 0 = setup per message, 1 = primed state + rewind
+void encode_paranoid(int mode)
+{
+  int k;
+  char code;
+
+  strcpy((char *) scratchpad, testmsg);
+  code = scratchpad[5];
+  strcpy((char *) msgbuf, (char *) scratchpad+6);
+
+  if (mode == 0)
+    prime(&pm_crypto1, &pm_crypto2, pdigest);
+  k = strlen((char *) msgbuf);
+  RC4_crypt(&pm_crypto1, &pm_crypto2, msgbuf, k);
+  if (mode == 1)
+    RC4_rewind(&pm_crypto1, &pm_crypto2, k);
+
+  strcpy((char *) scratchpad, "MP-0 EM");
+  scratchpad[7] = code;
+  base64encode(msgbuf, k, scratchpad+8);
+
+  txencode();
+}
+
+double bench(int mode, long n)
+{
+  clock_t t0, t1;
+  long i;
+
+  prime(&tx_crypto1, &tx_crypto2, txdigest);
+  prime(&pm_crypto1, &pm_crypto2, pdigest);
+  t0 = clock();
+  for (i = 0; i < n; i++)
+  {
+    if (mode < 0)
+      encode_normal();
+    else
+      encode_paranoid(mode);
+  }
+  t1 = clock();
+  if (t1 == t0)
+    t1++;
+  return (double) n * CLOCKS_PER_SEC / (t1 - t0);
+}
+
+/*******************************************************************************
+ * +IPD line framing & decoding (as net_poll / net_msg_in)
+ *
+ * (base64decode copied from vehicle/OVMS.X/crypt_base64.c, RX ring as
+ * vehicle/OVMS.X/UARTIntC.c without the interrupt handling)
+ *
+ */
+
+static const unsigned char cd64[] = "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+
+void decodeblock( unsigned char in[4], unsigned char out[3] )
+{
+  out[ 0 ] = (unsigned char ) (in[0] << 2 | in[1] >> 4);
+  out[ 1 ] = (unsigned char ) (in[1] << 4 | in[2] >> 2);
+  out[ 2 ] = (unsigned char ) (((in[2] << 6) & 0xc0) | in[3]);
+}
+
+int base64decode(unsigned char *inputData, unsigned char *outputData)
+{
+  unsigned char in[4], out[3];
+  unsigned char c = 1;
+  unsigned char v;
+  int i, len;
+  int written = 0;
+
+  while (c != 0)
+  {
+    for (len = 0, i = 0; (i < 4) && (c != 0); i++)
+    {
+      v = 0;
+      while ((c != 0) && (v == 0))
+      {
+        c = (*inputData) ? *inputData++ : 0;
+        v = (unsigned char) ((c < 43 || c > 122) ? 0 : cd64[ c - 43 ]);
+        if (v)
+          v = (unsigned char) ((v == '$') ? 0 : v - 61);
+      }
+      if (c != 0)
+      {
+        len++;
+        if (v)
+          in[ i ] = (unsigned char) (v - 1);
+      }
+      else
+        in[i] = 0;
+    }
+    if (len)
+    {
+      decodeblock(in, out);
+      for (i = 0; i < len - 1; i++)
+      {
+        *outputData++ = out[i];
+        written++;
+      }
+    }
+  }
+  *outputData = 0;
+  return written;
+}
+
+#define RX_BUFFER_SIZE 128
+#define RX_LINES 32
+
+// Server records (as received from the server):
+const char *rxsamples[] =
+{
+  "MP-0 S90,K,220,32,charging,standard,181,160,291,257,13,0,120,9,5,21,1,0,"
+    "1380,0,160.00,0,-1,0,55,60,0,-1,0,0,0,0,2,7.0,378.5,100",
+  "MP-0 D160,4,4,35,40,23,1234,98765,0,3600,14,0,120,120,12.8,0,13.2,0,22,0.5",
+  "MP-0 L51.123456,-0.123456,270,102,1,120,0,35,0A,-12.5,1234,567",
+  "MP-0 W29.5,21,29.0,22,31.5,22,31.0,23,120",
+};
+
+#define RXSAMPLES ((int) (sizeof(rxsamples)/sizeof(char *)))
+
+unsigned char rxring[RX_BUFFER_SIZE];
+unsigned char rxcnt, rxwr, rxrd;
+long rxlocks;                         // interrupt lock sections taken
+
+unsigned char rxstream[RX_LINES * NET_BUF_MAX];
+int rxstreamlen;
+char rxlast[NET_BUF_MAX];
+long rxlines;
+
+RC4_CTX1 rx_crypto1;
+RC4_CTX2 rx_crypto2;
+
+void rx_put(unsigned char c)
+{
+  rxring[rxwr] = c;
+  if (++rxwr == RX_BUFFER_SIZE)
+    rxwr = 0;
+  rxcnt++;
+}
+
+int rx_getchar(unsigned char *c)
+{
+  if (rxcnt == 0)
+    return 0;
+  *c = rxring[rxrd];
+  if (++rxrd == RX_BUFFER_SIZE)
+    rxrd = 0;
+  rxlocks++;
+  rxcnt--;
+  return 1;
+}
+
+unsigned char rx_getblock(unsigned char *buf, unsigned char max, unsigned char stop)
+{
+  unsigned char n, avail;
+
+  avail = (rxcnt > max) ? max : rxcnt;
+  for (n = 0; n < avail; )
+  {
+    buf[n] = rxring[rxrd];
+    if (++rxrd == RX_BUFFER_SIZE)
+      rxrd = 0;
+    if (buf[n++] == stop)
+      break;
+  }
+  if (n == 0)
+    return 0;
+  rxlocks++;
+  rxcnt -= n;
+  return n;
+}
+
+// Build a +IPD payload of RX_LINES encrypted & encoded records:
+void rx_compose(void)
+{
+  int i;
+  unsigned char *p = rxstream;
+
+  prime(&tx_crypto1, &tx_crypto2, txdigest);
+  for (i = 0; i < RX_LINES; i++)
+  {
+    strcpy((char *) scratchpad, rxsamples[i % RXSAMPLES]);
+    txencode();
+    strcpy((char *) p, (char *) outbuf);
+    p += strlen((char *) outbuf);
+    *p++ = '\r';
+    *p++ = '\n';
+  }
+  rxstreamlen = p - rxstream;
+}
+
+void rx_line(unsigned char *buf, int pos)
+{
+  int k;
+
+  buf[pos] = 0;
+  k = base64decode(buf, msgbuf);
+  RC4_crypt(&rx_crypto1, &rx_crypto2, msgbuf, k);
+  memcpy(rxlast, msgbuf, k + 1);
+  rxlines++;
+}
+
+// mode 0 = per character (old net_poll), 1 = line blocks (UARTIntGetBlock)
+void rx_poll(int mode, unsigned char *buf, int *pos, int *todo)
+{
+  unsigned char x, k;
+
+  while (rx_getchar(&x))
+  {
+    if (mode == 0)
+    {
+      if (x != 0x0d)
+      {
+        buf[(*pos)++] = x;
+        if (*pos == NET_BUF_MAX) (*pos)--;
+      }
+      (*todo)--;
+    }
+    else
+    {
+      buf[(*pos)++] = x;
+      if (*pos == NET_BUF_MAX) (*pos)--;
+      (*todo)--;
+      if ((x != 0x0a) && (*todo > 0))
+      {
+        k = (NET_BUF_MAX-1) - *pos;
+        if (k > *todo) k = *todo;
+        k = rx_getblock(buf + *pos, k, 0x0a);
+        *pos += k;
+        *todo -= k;
+        if (k > 0) x = buf[*pos - 1];
+      }
+    }
+    if (x == 0x0a)
+    {
+      (*pos)--;
+      if ((mode == 1) && (*pos > 0) && (buf[*pos - 1] == 0x0d))
+        (*pos)--;
+      rx_line(buf, *pos);
+      *pos = 0;
+    }
+    if (*todo == 0)
+      break;
+  }
+}
+
+// Feed the payload through the ring in chunks of up to chunk bytes,
+// polling after each chunk like the main loop does:
+void rx_run(int mode, int chunk)
+{
+  unsigned char buf[NET_BUF_MAX];
+  int pos = 0, todo = rxstreamlen, fed = 0, k;
+
+  rxcnt = rxwr = rxrd = 0;
+  while (todo > 0)
+  {
+    for (k = 0; (k < chunk) && (fed < rxstreamlen) && (rxcnt < RX_BUFFER_SIZE); k++)
+      rx_put(rxstream[fed++]);
+    rx_poll(mode, buf, &pos, &todo);
+  }
+}
+
+double bench_rx(int mode, int chunk, long n)
+{
+  clock_t t0, t1;
+  long i;
+
+  prime(&rx_crypto1, &rx_crypto2, txdigest);
+  rxlocks = 0;
+  t0 = clock();
+  for (i = 0; i < n; i++)
+    rx_run(mode, chunk);
+  t1 = clock();
+  if (t1 == t0)
+    t1++;
+  return (double) n * rxstreamlen * CLOCKS_PER_SEC / (t1 - t0);
+}
+
+int main(int argc, char *argv[])
+{
+  long n = (argc > 1) ? atol(argv[1]) : 100000;
+  char out0[NET_BUF_MAX*2];
+  int i;
+
+  if (n <= 0)
+  {
+    fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  // check primed state reuse gives the same results as a new setup:
+  prime(&tx_crypto1, &tx_crypto2, txdigest);
+  prime(&pm_crypto1, &pm_crypto2, pdigest);
+  for (i = 0; i < 3; i++)
+  {
+    encode_paranoid(0);
+    memcpy(out0, msgbuf, NET_BUF_MAX);
+    prime(&pm_crypto1, &pm_crypto2, pdigest);
+    encode_paranoid(1);
+    encode_paranoid(1);
+    if (memcmp(out0, msgbuf, strlen(testmsg)-6) != 0)
+    {
+      fprintf(stderr, "ERROR: paranoid mode encoding mismatch\n");
+      return 2;
+    }
+  }
+
+  printf("normal:                %10.0f msgs/sec\n", bench(-1, n));
+  printf("paranoid (setup/msg):  %10.0f msgs/sec\n", bench(0, n / 20 + 1));
+  printf("paranoid (primed):     %10.0f msgs/sec\n", bench(1, n));
+
+  rx_compose();
+  for (i = 0; i < 2; i++)
+  {
+    prime(&rx_crypto1, &rx_crypto2, txdigest);
+    rxlines = 0;
+    rx_run(i, 64);
+    if ((rxlines != RX_LINES)
+        || (strcmp(rxlast, rxsamples[(RX_LINES-1) % RXSAMPLES]) != 0))
+    {
+      fprintf(stderr, "ERROR: +IPD framing mismatch in mode %d\n", i);
+      return 2;
+    }
+  }
+  printf("\n+IPD %d lines, %d bytes  %12s %12s\n", RX_LINES, rxstreamlen,
+    "bytes/sec", "locks/line");
+  for (i = 0; i < 4; i++)
+  {
+    int chunk = (i & 1) ? RX_BUFFER_SIZE : 16;
+    double bps = bench_rx(i >> 1, chunk, n / 100 + 1);
+    printf("%-10s chunk %3d      %12.0f %12.1f\n", (i >> 1) ? "block" : "per char",
+      chunk, bps, (double) rxlocks / ((n / 100 + 1) * RX_LINES));
+  }
+  return 0;
+}
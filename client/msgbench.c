@@ -0,0 +1,512 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * msgbench: host benchmark of the firmware message composition
+ * 	(net_msgp_* records, the CRC16 change detection of
+ * 	net_msg_encode_statputs, OVMS_BINMSG records and parameter access)
+ *
+ * Compares composition plus bitwise CRC16 against the nibble table CRC16
+ * for messages shaped like the net_msgp_* outputs.
+ *
+ * Shows the wire size of S/D/L/W records in text and binary (OVMS_BINMSG)
+ * form, and checks the binary form decodes back to the text record.
+ *
+ * Compares the stat message composition reading the units parameter from
+ * the (simulated) EEPROM against the RAM copy, and counts the EEPROM
+ * writes of par_set() writing all bytes against changed bytes only.
+ *
+ * Usage:
+ *  ./msgbench [iterations]
+ *
+ * Build:
+ *  gcc -O2 -o msgbench msgbench.c
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define NET_BUF_MAX 200
+
+unsigned char scratchpad[NET_BUF_MAX];
+unsigned char outbuf[NET_BUF_MAX*2];
+
+/*******************************************************************************
+ * Message composition & CRC16 (as net_msgp_* / net_msg_encode_statputs)
+ *
+ * (crc16 copied from vehicle/OVMS.X/utils.c)
+ *
+ */
+
+unsigned short crc16_bits(char *data, int length)
+{
+  unsigned short crc = 0xffff;
+  int k;
+
+  while (length>0)
+  {
+    crc ^= (unsigned char)*data++;
+    length--;
+    for (k = 0; k < 8; ++k)
+    {
+      if (crc & 1)
+        crc = (crc >> 1) ^ 0xA001;
+      else
+        crc = (crc >> 1);
+    }
+  }
+  return crc;
+}
+
+const unsigned short crc16_tab[16] =
+{
+  0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+  0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+
+unsigned short crc16_str(char *s)
+{
+  unsigned short crc = 0xffff;
+  unsigned char b;
+
+  while ((b = *s++))
+  {
+    crc = (crc >> 4) ^ crc16_tab[(crc ^ b) & 0x0f];
+    crc = (crc >> 4) ^ crc16_tab[(crc ^ (b >> 4)) & 0x0f];
+  }
+  return crc;
+}
+
+char *stp_rom(char *dst, const char *val)
+{
+  while ((*dst = *val++)) dst++;
+  return dst;
+}
+
+char *stp_i(char *dst, const char *prefix, long val)
+{
+  char buf[12];
+  int n = 0;
+  unsigned long u = (val < 0) ? -val : val;
+
+  if (prefix)
+    dst = stp_rom(dst, prefix);
+  if (val < 0)
+    *dst++ = '-';
+  do { buf[n++] = '0' + (u % 10); u /= 10; } while (u);
+  while (n) *dst++ = buf[--n];
+  *dst = 0;
+  return dst;
+}
+
+// Sample field values per message type, composed like net_msgp_*:
+typedef struct
+{
+  const char *name;
+  const char *prefix;
+  int nfields;
+  long fields[48];
+  const char *tail;
+} msgtype_t;
+
+msgtype_t msgtypes[] =
+{
+  { "stat (S)", "MP-0 S", 40,
+    { 90,220,13,181,160,291,257,0,120,9,5,21,1,0,1380,0,-1,36000,8400,
+      2,0,0,55,60,0,0,0,0,0,0,0,0,0,0,0,0,2,121,3801,100 }, NULL },
+  { "gps (L)", "MP-0 L", 12,
+    { 51123456,-7123456,270,102,1,120,0,35,0,125,30241,21011 }, NULL },
+  { "tpms (W)", "MP-0 W", 9,
+    { 29,21,29,22,31,22,31,23,120 }, NULL },
+  { "firmware (F)", "MP-0 F", 7,
+    { 3,2,1,2,21,1,8 }, ",RT/V2/SFZRE2B39A3000359,TR,T-Mobile" },
+  { "environment (D)", "MP-0 D", 21,
+    { 160,0,4,35,40,23,1234,98765,0,3600,14,0,120,120,138,0,140,0,0,22,12 }, NULL },
+  { "capabilities (V)", "MP-0 V", 0,
+    { 0 }, "C10,C11,C1-9,C40-41,C49" },
+};
+
+#define MSGTYPES ((int) (sizeof(msgtypes)/sizeof(msgtype_t)))
+
+void compose(msgtype_t *t)
+{
+  char *s;
+  int k;
+
+  s = stp_rom((char *) scratchpad, t->prefix);
+  for (k = 0; k < t->nfields; k++)
+    s = stp_i(s, (k > 0) ? "," : NULL, t->fields[k]);
+  if (t->tail)
+    s = stp_rom(s, t->tail);
+}
+
+volatile unsigned short crcsink;
+
+// mode 0 = compose only, 1 = + bitwise crc16, 2 = + nibble table crc16
+double bench_crc(msgtype_t *t, int mode, long n)
+{
+  clock_t t0, t1;
+  long i;
+
+  t0 = clock();
+  for (i = 0; i < n; i++)
+  {
+    compose(t);
+    if (mode == 1)
+      crcsink = crc16_bits((char *) scratchpad, strlen((char *) scratchpad));
+    else if (mode == 2)
+      crcsink = crc16_str((char *) scratchpad);
+  }
+  t1 = clock();
+  if (t1 == t0)
+    t1++;
+  return (double) (t1 - t0) * 1e9 / CLOCKS_PER_SEC / n;
+}
+
+/*******************************************************************************
+ * Binary records (as net_msg_bin_encode / ovms_server.pl io_bin_decode)
+ *
+ */
+
+const char *binsamples[] =
+{
+  "MP-0 S90,K,220,32,charging,standard,181,160,291,257,13,0,120,9,5,21,1,0,"
+    "1380,0,160.00,0,-1,0,55,60,0,-1,0,0,0,0,2,7.0,378.5,100",
+  "MP-0 D160,4,4,35,40,23,1234,98765,0,3600,14,0,120,120,12.8,0,13.2,0,22,0.5",
+  "MP-0 L51.123456,-0.123456,270,102,1,120,0,35,0A,-12.5,1234,567",
+  "MP-0 W29.5,21,29.0,22,31.5,22,31.0,23,120",
+};
+
+#define BINSAMPLES ((int) (sizeof(binsamples)/sizeof(char *)))
+
+int bin_encode(const char *text, unsigned char *out)
+{
+  const char *p, *f, *q;
+  unsigned char *d;
+  signed char neg, dec, nd;
+  unsigned long v;
+
+  d = (unsigned char *) stp_rom((char *) out, "MP-0 b");
+  *d++ = text[5];
+  for (f=p=text+6; ; p++)
+  {
+    if ((*p != ',') && (*p != 0))
+      continue;
+    neg = (*f == '-');
+    q = f + neg;
+    v = 0; dec = -1; nd = 0;
+    if ((*q == '0') && (q[1] >= '0') && (q[1] <= '9'))
+      q = p;
+    else if (q == p)
+      nd = -1;
+    for (; q < p; q++)
+    {
+      if ((*q >= '0') && (*q <= '9') && (nd < 9))
+      {
+        v = v * 10 + (*q - '0');
+        nd++;
+        if (dec >= 0) dec++;
+      }
+      else if ((*q == '.') && (dec < 0) && (nd > 0))
+        dec = 0;
+      else
+        break;
+    }
+    if (p == f)
+      *d++ = 0x48;
+    else if ((q == p) && (nd > 0) && (dec != 0) && (dec <= 7) && !(neg && (v == 0)))
+    {
+      if ((!neg) && (dec < 0) && (v < 0x40))
+        *d++ = v;
+      else
+      {
+        *d++ = 0x40 + ((dec < 0) ? 0 : dec);
+        v = (neg) ? (v << 1) - 1 : (v << 1);
+        while (v >= 0x80)
+        {
+          *d++ = (v & 0x7f) | 0x80;
+          v >>= 7;
+        }
+        *d++ = v;
+      }
+    }
+    else
+    {
+      if ((p - f) > 0x7f)
+        return -1;
+      *d++ = 0x80 | (p - f);
+      while (f < p) *d++ = *f++;
+    }
+    if (*p == 0) break;
+    f = p + 1;
+  }
+  return d - out;
+}
+
+int bin_decode(const unsigned char *bin, int len, char *text)
+{
+  int pos = 7, first = 1, k;
+  unsigned char t, b;
+  unsigned long z;
+  long v;
+  char digits[24];
+
+  text = stp_rom(text, "MP-0 ");
+  *text++ = bin[6];
+  while (pos < len)
+  {
+    if (!first) *text++ = ',';
+    first = 0;
+    t = bin[pos++];
+    if (t < 0x40)
+      text = stp_i(text, NULL, t);
+    else if (t <= 0x47)
+    {
+      for (z = 0, k = 0, b = 0x80; b & 0x80; k += 7)
+      {
+        if (pos >= len) return -1;
+        b = bin[pos++];
+        z |= (unsigned long) (b & 0x7f) << k;
+      }
+      v = (z & 1) ? -(long) ((z + 1) >> 1) : (long) (z >> 1);
+      if (t == 0x40)
+        text = stp_i(text, NULL, v);
+      else
+      {
+        k = t - 0x40;
+        sprintf(digits, "%0*ld", k + 1, (v < 0) ? -v : v);
+        if (v < 0) *text++ = '-';
+        memcpy(text, digits, strlen(digits) - k);
+        text += strlen(digits) - k;
+        *text++ = '.';
+        text = stp_rom(text, digits + strlen(digits) - k);
+      }
+    }
+    else if (t == 0x48)
+      ;
+    else if (t >= 0x80)
+    {
+      k = t & 0x7f;
+      if (pos + k > len) return -1;
+      memcpy(text, bin + pos, k);
+      text += k;
+      pos += k;
+    }
+    else
+      return -1;
+  }
+  *text = 0;
+  return 0;
+}
+
+// base64 length of n bytes plus "\r\n"
+#define WIRELEN(n) ((((n) + 2) / 3) * 4 + 2)
+
+/*******************************************************************************
+ * Parameter access (as params.c par_read / par_write)
+ *
+ * The EEPROM is simulated by a volatile array accessed byte by byte like
+ * the EEADR/EEDATA registers.
+ *
+ */
+
+#define PARAM_MAX 32
+#define PARAM_MAX_LENGTH 32
+#define PARAM_MILESKM 2
+#define PARAM_NOTIFIES 3
+#define PARAM_GPRSAPN 5
+
+volatile unsigned char eeprom[PARAM_MAX * PARAM_MAX_LENGTH];
+char par_value[PARAM_MAX_LENGTH];
+long ee_reads, ee_writes;
+char can_mileskm = 'K';
+
+void par_read(unsigned char param)
+{
+  int k;
+
+  for (k = 0; k < PARAM_MAX_LENGTH; k++)
+    par_value[k] = eeprom[param * PARAM_MAX_LENGTH + k];
+  ee_reads += PARAM_MAX_LENGTH;
+}
+
+char *par_get(unsigned char param)
+{
+  par_read(param);
+  par_value[PARAM_MAX_LENGTH-1] = 0;
+  return par_value;
+}
+
+// mode 0 = write all bytes, 1 = write changed bytes only
+void par_write(unsigned char param, int mode)
+{
+  int k;
+  volatile unsigned char *ee = eeprom + param * PARAM_MAX_LENGTH;
+
+  for (k = 0; k < PARAM_MAX_LENGTH; k++)
+  {
+    if (mode == 1)
+    {
+      ee_reads++;
+      if (ee[k] == (unsigned char) par_value[k])
+        continue;
+    }
+    ee[k] = par_value[k];
+    ee_writes++;
+  }
+}
+
+void par_set(unsigned char param, const char *value, int mode)
+{
+  strncpy(par_value, value, PARAM_MAX_LENGTH);
+  par_value[PARAM_MAX_LENGTH-1] = 0;
+  par_write(param, mode);
+}
+
+// Compose the net_msgp_stat message, units from par_get (mode 0)
+// or from the RAM copy can_mileskm (mode 1):
+void compose_stat(int mode)
+{
+  char units[2];
+  char *p, *s;
+  int k;
+  msgtype_t *t = &msgtypes[0];
+
+  if (mode == 0)
+    p = par_get(PARAM_MILESKM);
+  else
+  {
+    units[0] = can_mileskm;
+    units[1] = 0;
+    p = units;
+  }
+  s = stp_i((char *) scratchpad, "MP-0 S", t->fields[0]);
+  s = stp_rom(s, ",");
+  s = stp_rom(s, p);
+  for (k = 1; k < t->nfields; k++)
+    s = stp_i(s, ",", t->fields[k]);
+}
+
+double bench_par(int mode, long n)
+{
+  clock_t t0, t1;
+  long i;
+
+  t0 = clock();
+  for (i = 0; i < n; i++)
+    compose_stat(mode);
+  t1 = clock();
+  if (t1 == t0)
+    t1++;
+  return (double) (t1 - t0) * 1e9 / CLOCKS_PER_SEC / n;
+}
+
+int main(int argc, char *argv[])
+{
+  long n = (argc > 1) ? atol(argv[1]) : 100000;
+  char back[NET_BUF_MAX];
+  int i;
+
+  if (n <= 0)
+  {
+    fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%-18s %5s %12s %12s %12s\n", "ns/msg", "len",
+    "compose", "+crc bits", "+crc table");
+  for (i = 0; i < MSGTYPES; i++)
+  {
+    compose(&msgtypes[i]);
+    if (crc16_bits((char *) scratchpad, strlen((char *) scratchpad))
+        != crc16_str((char *) scratchpad))
+    {
+      fprintf(stderr, "ERROR: crc16 mismatch\n");
+      return 2;
+    }
+    printf("%-18s %5d %12.1f %12.1f %12.1f\n", msgtypes[i].name,
+      (int) strlen((char *) scratchpad),
+      bench_crc(&msgtypes[i], 0, n),
+      bench_crc(&msgtypes[i], 1, n),
+      bench_crc(&msgtypes[i], 2, n));
+  }
+
+  printf("\n%-18s %8s %8s %8s %8s %7s\n", "bytes/msg", "text", "binary",
+    "wire txt", "wire bin", "saving");
+  for (i = 0; i < BINSAMPLES; i++)
+  {
+    int tl = strlen(binsamples[i]);
+    int bl = bin_encode(binsamples[i], outbuf);
+
+    if ((bl < 0) || (bin_decode(outbuf, bl, back) != 0)
+        || (strcmp(back, binsamples[i]) != 0))
+    {
+      fprintf(stderr, "ERROR: binary record mismatch for %.6s\n", binsamples[i]);
+      return 2;
+    }
+    printf("%-18.6s %8d %8d %8d %8d %6.0f%%\n", binsamples[i], tl, bl,
+      WIRELEN(tl), WIRELEN(bl), 100.0 - 100.0 * WIRELEN(bl) / WIRELEN(tl));
+  }
+
+  strcpy(par_value, "K");
+  par_write(PARAM_MILESKM, 0);
+  compose_stat(0);
+  strcpy(back, (char *) scratchpad);
+  compose_stat(1);
+  if (strcmp(back, (char *) scratchpad) != 0)
+  {
+    fprintf(stderr, "ERROR: stat composition mismatch\n");
+    return 2;
+  }
+  ee_reads = 0;
+  compose_stat(0);
+  printf("\n%-22s %10s %10s\n", "stat (S) units", "ns/msg", "EE reads");
+  printf("%-22s %10.1f %10ld\n", "par_get(MILESKM)", bench_par(0, n), ee_reads);
+  printf("%-22s %10.1f %10d\n", "can_mileskm", bench_par(1, n), 0);
+
+  printf("\n%-22s %10s %10s\n", "par_set writes", "all bytes", "changed");
+  for (i = 0; i < 4; i++)
+  {
+    static const char *values[4] = { "SMS,IP", "SMS,IP", "IP", "internet.example.com" };
+    static const unsigned char params[4] = { PARAM_NOTIFIES, PARAM_NOTIFIES,
+      PARAM_NOTIFIES, PARAM_GPRSAPN };
+    long w0, w1;
+
+    par_set(params[i], "", 0);
+    if (i > 0)
+      par_set(params[i], values[i-1], 0);
+    ee_writes = 0;
+    par_set(params[i], values[i], 0);
+    w0 = ee_writes;
+    par_set(params[i], "", 0);
+    if (i > 0)
+      par_set(params[i], values[i-1], 0);
+    ee_writes = 0;
+    par_set(params[i], values[i], 1);
+    w1 = ee_writes;
+    printf("%-22s %10ld %10ld\n", values[i], w0, w1);
+  }
+  return 0;
+}
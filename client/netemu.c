@@ -0,0 +1,1368 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * netemu: host emulation of the modem link (net.c, net_msg.c, net_sms.c)
+ *
+ * Runs the firmware main loop (ovms.c) with the network modules against a
+ * simulated SIMCOM modem and OVMS server on an emulated clock. Emulated
+ * hardware: interrupt driven UART (9600 / OVMS_FASTBAUD rate, characters
+ * lost on rate mismatch), TMR0, TMR2 (delays), EEPROM (params) and the
+ * modem PWRKEY line on RB0. The stub processor header is in pic18host/.
+ *
+ * Reports time-to-READY, time-to-login and the UART bytes exchanged, as
+ * measured by the emulator (from power on / connection loss) and by the
+ * firmware (net_conn_*, from FIRSTRUN / connection loss, see SMS DIAG).
+ *
+ * Usage:
+ *  ./netemu [options]      single run
+ *  ./netemu test           built-in scenarios, exit code 1 on failure
+ *
+ * Options:
+ *  -t <sec>            run time (default 120)
+ *  -d <ms>             modem response delay (default 20)
+ *  -g <ms>             network registration delay (COPS, default 3000)
+ *  -p <ms>             GPRS attach delay (CIICR, default 1500)
+ *  -c <ms>             TCP connect delay (CIPSTART, default 500)
+ *  -l <ms>             server latency (default 100)
+ *  -b <baud>           modem rate at power on (default 9600, 0 = autobaud)
+ *  -F <n>              modem loses the first <n> command lines at a fast rate
+ *  -e <cmd>[,<n>]      modem answers ERROR to the first <n> (default 1) <cmd>
+ *  -x <cmd>[,<n>]      modem ignores the first <n> (default 1) <cmd>
+ *  -s <sec>,<text>     SMS from PARAM_REGPHONE at <sec>
+ *  -m <sec>,<msg>      server message "MP-0 <msg>" at <sec>
+ *  -k <sec>            server closes the TCP connection at <sec>
+ *  -r <sec>,<code>     firmware requests error alert <code> at <sec>
+ *  -v                  trace modem traffic & state changes
+ *
+ *  <cmd> is matched against the start of each ';' part of a command line,
+ *  without the "AT", e.g. "+CIICR" or "+IPR=57600".
+ *
+ * Build:
+ *  gcc -O2 -Ipic18host -o netemu netemu.c
+ *  gcc -O2 -Ipic18host -DOVMS_FASTBAUD -o netemu netemu.c
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Build configuration (as set by the MPLAB project):
+#if !defined(OVMS_HW_V1) && !defined(OVMS_HW_V2)
+#define OVMS_HW_V2 1
+#endif
+#if !defined(OVMS_SIMCOM_SIM908) && !defined(OVMS_SIMCOM_SIM808)
+#define OVMS_SIMCOM_SIM908 1
+#endif
+#define OVMS_CAR_NONE 1
+#define OVMS_BUILDCONFIG "NETEMU"
+
+// UART driver state accessed through the UART model, so the firmware
+// busy-waits on the TX buffer advance the emulated time:
+struct status;
+extern volatile struct status *emu_uart_status(void);
+extern volatile unsigned char *emu_uart_txcnt(void);
+#define vUARTIntStatus (*emu_uart_status())
+#define vUARTIntTxBufDataCnt (*emu_uart_txcnt())
+
+// EEPROM image: the low address byte of a parameter is the EEADR value
+extern char EEparam[32][32] __attribute__((aligned(256)));
+
+// UARTIntC.h (the mSetUARTBaud macros don't pass the gcc preprocessor):
+#define _UARTIntC_H
+#include "../vehicle/OVMS.X/UARTIntC.def"
+#define TX_BUFFER_SIZE UARTINTC_TX_BUFFER_SIZE
+#define RX_BUFFER_SIZE UARTINTC_RX_BUFFER_SIZE
+#define TXON 1
+#define RXON 1
+#define TXON_AND_RXON 1
+#define TXOFF_AND_RXON 0
+#define BRGH_VAL 1
+#define TX_PRIORITY_ON 0
+#define RX_PRIORITY_ON 0
+#define SPBRG_VAL ((UART_CLOCK_FREQ / UARTINTC_BAUDRATE)/16 - 1)
+struct status
+  {
+  unsigned UARTIntTxBufferFull  :1;
+  unsigned UARTIntTxBufferEmpty :1;
+  unsigned UARTIntRxBufferFull  :1;
+  unsigned UARTIntRxBufferEmpty :1;
+  unsigned UARTIntRxOverFlow :1;
+  unsigned UARTIntRxError:1;
+  };
+extern volatile unsigned char vUARTIntTxBuffer[TX_BUFFER_SIZE];
+extern volatile unsigned char vUARTIntTxBufWrPtr;
+extern volatile unsigned char vUARTIntTxBufRdPtr;
+extern volatile unsigned char vUARTIntRxBuffer[RX_BUFFER_SIZE];
+extern volatile unsigned char vUARTIntRxBufDataCnt;
+extern volatile unsigned char vUARTIntRxBufWrPtr;
+extern volatile unsigned char vUARTIntRxBufRdPtr;
+extern volatile unsigned int vUARTIntRxOverFlowCnt;
+unsigned char UARTIntGetChar(unsigned char*);
+unsigned char UARTIntGetBlock(unsigned char*, unsigned char, unsigned char);
+unsigned char UARTIntGetRxBufferDataSize(void);
+unsigned char UARTIntPutChar(unsigned char);
+unsigned char UARTIntGetTxBufferEmptySpace(void);
+void UARTIntInit(void);
+void UARTIntISR(void);
+
+// Firmware modules:
+#include "../vehicle/OVMS.X/UARTIntC.c"
+#include "../vehicle/OVMS.X/params.c"
+#include "../vehicle/OVMS.X/crypt_base64.c"
+#include "../vehicle/OVMS.X/crypt_md5.c"
+#include "../vehicle/OVMS.X/crypt_hmac.c"
+#include "../vehicle/OVMS.X/crypt_rc4.c"
+
+extern void emu_reset_cpu(void);
+#define _asm { emu_reset_cpu(); { int reset; (void)
+#define _endasm ; } }
+#include "../vehicle/OVMS.X/utils.c"
+#undef _asm
+#undef _endasm
+
+#define _asm (void)
+#define goto
+#define _endasm ;
+#include "../vehicle/OVMS.X/net.c"
+#undef goto
+#undef _asm
+#undef _endasm
+
+#include "../vehicle/OVMS.X/net_msg.c"
+#include "../vehicle/OVMS.X/net_sms.c"
+
+#define main ovms_main
+#include "../vehicle/OVMS.X/ovms.c"
+#undef main
+
+
+////////////////////////////////////////////////////////////////////////
+// Stubs for the vehicle, LED and inputs modules
+//
+
+unsigned char can_databuffer[8];
+unsigned char can_minSOCnotified = 0;
+unsigned char can_mileskm = 'K';
+unsigned char* vehicle_version = (unsigned char*) "EMU";
+unsigned char* can_capabilities = (unsigned char*) "";
+BOOL (*vehicle_fn_commandhandler)(BOOL msgmode, int code, char* msg) = NULL;
+BOOL (*vehicle_fn_smshandler)(BOOL premsg, char *caller, char *command, char *arguments) = NULL;
+BOOL (*vehicle_fn_smsextensions)(char *caller, char *command, char *arguments) = NULL;
+int (*vehicle_fn_minutestocharge)(unsigned char chgmod, int wAvail, int imStart, int imTarget, int pctTarget, int cac100, signed char degAmbient, int *pimExpect) = NULL;
+
+void vehicle_initialise(void)
+  {
+  can_mileskm = *par_get(PARAM_MILESKM);
+  }
+void vehicle_idlepoll(void) { }
+void vehicle_ticker(void) { }
+void vehicle_ticker10th(void) { }
+
+unsigned char led_code[OVMS_LED_N];
+void led_initialise(void) { }
+void led_set(unsigned char led, signed char digits) { led_code[led] = digits; }
+void led_start(void) { }
+void led_isr(void) { }
+
+void inputs_initialise(void) { }
+unsigned char inputs_gsmgprs(void) { return 1; }
+float inputs_voltage(void) { return 12.6; }
+
+
+////////////////////////////////////////////////////////////////////////
+// Emulated clock & SFRs
+//
+
+#define NS_MS 1000000ULL
+#define NS_S  1000000000ULL
+#define EMU_LOOP_NS 50000ULL            // main loop turn
+#define EMU_POLL_NS 1000ULL             // SFR / UART status poll
+#define EMU_TMR0_NS 51200ULL            // TMR0 tick (5 MHz / 256)
+
+volatile unsigned char TMR0L, TMR0H, T0CON;
+volatile unsigned char TMR2, PR2, T2CON;
+volatile unsigned char SPBRG, SPBRGH, TXREG, RCREG;
+volatile unsigned char TRISB, RCON = 0x1c, INTCON; // RCON: power on
+volatile unsigned char EECON1, EECON2, EEADR, EEADRH;
+volatile STKPTRbits_t STKPTRbits;
+volatile PIE1bits_t PIE1bits;
+volatile IPR1bits_t IPR1bits;
+volatile RCSTAbits_t RCSTAbits;
+volatile BAUDCONbits_t BAUDCONbits;
+volatile PORTBbits_t PORTBbits;
+volatile PORTCbits_t PORTCbits;
+volatile TRISCbits_t TRISCbits;
+
+static volatile struct status emu_uart_statusreg;
+static volatile unsigned char emu_uart_txcntreg;
+static volatile PIR1bits_t emu_pir1reg;
+static volatile TXSTAbits_t emu_txstareg;
+static volatile unsigned char emu_eedatareg;
+
+static unsigned long long emu_now;      // emulated time [ns]
+static unsigned long long emu_end;      // end of run [ns]
+static unsigned long long emu_tmr0rest; // TMR0 prescaler [ns]
+static unsigned long long emu_tmr2next; // next TMR2IF [ns]
+static unsigned char emu_hw;            // 1 = in the hardware model
+static jmp_buf emu_exit;
+static const char *emu_exitreason;
+
+static unsigned char emu_rb0;           // PWRKEY line state
+static unsigned long long emu_rb0low;   // PWRKEY pulled low since
+
+static int emu_verbose;
+
+static void emu_advance(unsigned long long ns);
+
+static void emu_log(const char *fmt, ...)
+  {
+  va_list ap;
+
+  if (!emu_verbose) return;
+  printf("[%9.3f] ", emu_now / 1e9);
+  va_start(ap, fmt);
+  vprintf(fmt, ap);
+  va_end(ap);
+  printf("\n");
+  }
+
+static void emu_timer0(unsigned long long ns)
+  {
+  unsigned int t;
+
+  emu_tmr0rest += ns;
+  t = (TMR0H << 8) + TMR0L + (unsigned int)(emu_tmr0rest / EMU_TMR0_NS);
+  emu_tmr0rest %= EMU_TMR0_NS;
+  TMR0H = (t >> 8) & 0xff;
+  TMR0L = t & 0xff;
+  }
+
+void emu_clrwdt(void)
+  {
+  emu_advance(EMU_LOOP_NS);
+  if (emu_now >= emu_end)
+    {
+    emu_exitreason = NULL;
+    longjmp(emu_exit, 1);
+    }
+  }
+
+void emu_delay_us(unsigned long us)
+  {
+  emu_advance(us * 1000ULL);
+  }
+
+void emu_reset_cpu(void)
+  {
+  emu_exitreason = "CPU reset";
+  longjmp(emu_exit, 1);
+  }
+
+volatile PIR1bits_t *emu_pir1(void)
+  {
+  unsigned long long period;
+
+  if (!emu_hw && (T2CON & 0x04) && !emu_pir1reg.TMR2IF)
+    {
+    // delays poll TMR2IF: skip to the next period
+    // T2CON: prescale 1/4/16, postscale 1..16
+    period = 200ULL * (PR2 + 1)
+           * ((T2CON & 0x03) == 0 ? 1 : ((T2CON & 0x03) == 1 ? 4 : 16))
+           * (((T2CON >> 3) & 0x0f) + 1);
+    if (emu_tmr2next <= emu_now)
+      emu_tmr2next = emu_now + period;
+    emu_advance(emu_tmr2next - emu_now);
+    emu_tmr2next += period;
+    emu_pir1reg.TMR2IF = 1;
+    }
+  return &emu_pir1reg;
+  }
+
+volatile TXSTAbits_t *emu_txsta(void);
+volatile struct status *emu_uart_status(void)
+  {
+  if (!emu_hw) emu_advance(EMU_POLL_NS);
+  return &emu_uart_statusreg;
+  }
+
+volatile unsigned char *emu_uart_txcnt(void)
+  {
+  if (!emu_hw) emu_advance(EMU_POLL_NS);
+  return &emu_uart_txcntreg;
+  }
+
+volatile unsigned char *emu_eecon1(void)
+  {
+  volatile EECON1bits_t *r = (volatile EECON1bits_t*) &EECON1;
+
+  if (r->WR)
+    {
+    // write cycle:
+    ((unsigned char*)EEparam)[(EEADRH << 8) | EEADR] = emu_eedatareg;
+    emu_advance(4 * NS_MS);
+    r->WR = 0;
+    }
+  return &EECON1;
+  }
+
+volatile unsigned char *emu_eedata(void)
+  {
+  volatile EECON1bits_t *r = (volatile EECON1bits_t*) &EECON1;
+
+  if (r->RD)
+    {
+    emu_eedatareg = ((unsigned char*)EEparam)[(EEADRH << 8) | EEADR];
+    r->RD = 0;
+    }
+  return &emu_eedatareg;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Emulated UART & modem
+//
+
+#define EMU_RXQ 8192
+#define EMU_ACTS 128
+#define EMU_INJECT 8
+
+enum { ACT_OUT, ACT_BAUD, ACT_BOOT, ACT_CONNECT, ACT_SMS, ACT_SRVMSG,
+       ACT_SRVINJECT, ACT_CLOSE, ACT_ERROR };
+
+typedef struct
+  {
+  unsigned long long due;
+  unsigned long seq;
+  int type;                             // ACT_*, -1 = free
+  long arg;
+  char text[320];
+  } emu_act_t;
+
+typedef struct
+  {
+  char cmd[32];
+  int cnt;
+  int ignore;                           // 0 = answer ERROR, 1 = no answer
+  } emu_inject_t;
+
+static struct
+  {
+  // config:
+  unsigned long long respdelay, regdelay, gprsdelay, conndelay, srvdelay;
+  unsigned long baud;                   // rate at power on (0 = autobaud)
+  int fastloss;                         // lines to lose at the fast rate
+  emu_inject_t inject[EMU_INJECT];
+  int injects;
+  } cfg;
+
+// UART:
+static unsigned char emu_txbusy, emu_txbyte;
+static unsigned long emu_txbaud;
+static unsigned long long emu_txdone;
+static struct { unsigned char c; unsigned long baud; unsigned long long due; } emu_rxq[EMU_RXQ];
+static int emu_rxqrd, emu_rxqlen;
+static unsigned long long emu_rxqlast;
+static unsigned long emu_uart_tx, emu_uart_rx;
+
+// Timed actions:
+static emu_act_t emu_act[EMU_ACTS];
+static unsigned long emu_actseq;
+
+// Modem:
+static struct
+  {
+  int on, ready;
+  unsigned long baud;                   // current rate (0 = autobaud)
+  unsigned long ipr;                    // stored rate
+  int echo;
+  int gprs, connecting, connected, qsend;
+  int mode;                             // 0 = command, 1 = CIPSEND, 2 = CMGS
+  char line[512];
+  int linelen;
+  char data[2048];
+  int datalen;
+  unsigned long long busy;              // responses queued until
+  } mdm;
+
+// SMS sent by the firmware:
+static int emu_sms_cnt, emu_sms_max, emu_sms_over;
+
+static void srv_rx(const char *data, int len);
+static void srv_connect(void);
+static void srv_inject(const char *msg);
+
+static unsigned long emu_host_baud(void)
+  {
+  if (BAUDCONbits.BRG16)
+    return 20000000UL / (4UL * (((SPBRGH << 8) | SPBRG) + 1));
+  else
+    return 20000000UL / (16UL * (SPBRG + 1));
+  }
+
+static int emu_baud_match(unsigned long a, unsigned long b)
+  {
+  return (a > b ? a - b : b - a) * 100 <= 3 * b;
+  }
+
+static unsigned long long emu_chartime(unsigned long baud)
+  {
+  return 10 * NS_S / (baud ? baud : 9600);
+  }
+
+static void emu_act_add(unsigned long long due, int type, long arg, const char *text)
+  {
+  int k;
+
+  for (k = 0; k < EMU_ACTS; k++)
+    if (emu_act[k].type < 0)
+      break;
+  if (k == EMU_ACTS)
+    {
+    fprintf(stderr, "netemu: action queue full\n");
+    exit(2);
+    }
+  emu_act[k].due = due;
+  emu_act[k].seq = emu_actseq++;
+  emu_act[k].type = type;
+  emu_act[k].arg = arg;
+  snprintf(emu_act[k].text, sizeof(emu_act[k].text), "%s", text ? text : "");
+  }
+
+static int emu_act_next(void)
+  {
+  int k, n = -1;
+
+  for (k = 0; k < EMU_ACTS; k++)
+    {
+    if (emu_act[k].type < 0)
+      continue;
+    if ((n < 0) || (emu_act[k].due < emu_act[n].due) ||
+        ((emu_act[k].due == emu_act[n].due) && (emu_act[k].seq < emu_act[n].seq)))
+      n = k;
+    }
+  return n;
+  }
+
+// Modem output to the UART RX line:
+static void mdm_puts(const char *s)
+  {
+  if (!mdm.on)
+    return;
+  if (emu_rxqlast < emu_now)
+    emu_rxqlast = emu_now;
+  for (; *s; s++)
+    {
+    if (emu_rxqlen == EMU_RXQ)
+      break;
+    emu_rxqlast += emu_chartime(mdm.baud);
+    emu_rxq[(emu_rxqrd + emu_rxqlen) % EMU_RXQ].c = *s;
+    emu_rxq[(emu_rxqrd + emu_rxqlen) % EMU_RXQ].baud = mdm.baud;
+    emu_rxq[(emu_rxqrd + emu_rxqlen) % EMU_RXQ].due = emu_rxqlast;
+    emu_rxqlen++;
+    }
+  }
+
+// Queue a modem response after <delay>, keeping the response order:
+static void mdm_reply(unsigned long long delay, const char *s)
+  {
+  unsigned long long due = emu_now + delay;
+
+  if (due < mdm.busy)
+    due = mdm.busy;
+  mdm.busy = due;
+  emu_act_add(due, ACT_OUT, 0, s);
+  }
+
+static void mdm_power(int on)
+  {
+  int k;
+
+  // drop pending modem output:
+  for (k = 0; k < EMU_ACTS; k++)
+    if ((emu_act[k].type == ACT_OUT) || (emu_act[k].type == ACT_BAUD) ||
+        (emu_act[k].type == ACT_BOOT) || (emu_act[k].type == ACT_CONNECT))
+      emu_act[k].type = -1;
+  mdm.on = on;
+  mdm.ready = 0;
+  mdm.connecting = mdm.connected = 0;
+  mdm.gprs = 0;
+  mdm.mode = 0;
+  mdm.linelen = 0;
+  mdm.echo = 1;
+  mdm.qsend = 0;
+  mdm.busy = 0;
+  mdm.baud = mdm.ipr;
+  emu_log("modem: power %s", on ? "on" : "off");
+  if (on)
+    emu_act_add(emu_now + 3 * NS_S, ACT_BOOT, 0, NULL);
+  }
+
+// Sample the PWRKEY line: a low pulse >= 1 s toggles the modem power
+static void emu_pwrkey(void)
+  {
+  if (PORTBbits.RB0 == emu_rb0)
+    return;
+  emu_rb0 = PORTBbits.RB0;
+  if (!emu_rb0)
+    emu_rb0low = emu_now;
+  else if (emu_now - emu_rb0low >= NS_S)
+    mdm_power(!mdm.on);
+  }
+
+static emu_inject_t *mdm_inject(const char *cmd)
+  {
+  int k;
+
+  for (k = 0; k < cfg.injects; k++)
+    if ((cfg.inject[k].cnt > 0) &&
+        (strncmp(cmd, cfg.inject[k].cmd, strlen(cfg.inject[k].cmd)) == 0))
+      return &cfg.inject[k];
+  return NULL;
+  }
+
+// Execute one command of a command line, append the response to <out>
+// and output following the final result code to <post>.
+// Returns 0 = OK, 1 = no final result code, -1 = ERROR
+static int mdm_command(char *c, char *out, char *post, unsigned long long *delay)
+  {
+  if (strncmp(c, "+IPR=", 5) == 0)
+    {
+    mdm.ipr = atol(c + 5); // switched after the response
+    }
+  else if (strcmp(c, "+IPR?") == 0)
+    sprintf(out + strlen(out), "\r\n+IPR: %lu\r\n", mdm.ipr);
+  else if ((strcmp(c, "E0") == 0) || (strcmp(c, "E1") == 0))
+    mdm.echo = c[1] - '0';
+  else if (strcmp(c, "+CSMINS?") == 0)
+    strcat(out, "\r\n+CSMINS: 0,1\r\n");
+  else if (strcmp(c, "+CCID") == 0)
+    strcat(out, "\r\n89490200001234567890\r\n");
+  else if (strcmp(c, "+CPIN?") == 0)
+    strcat(out, "\r\n+CPIN: READY\r\n");
+  else if (strncmp(c, "+COPS=", 6) == 0)
+    *delay += cfg.regdelay;
+  else if (strcmp(c, "+COPS?") == 0)
+    strcat(out, "\r\n+COPS: 0,0,\"EMU NET\"\r\n");
+  else if (strcmp(c, "+CREG?") == 0)
+    strcat(out, "\r\n+CREG: 1,1\r\n");
+  else if (strcmp(c, "+CSQ") == 0)
+    strcat(out, "\r\n+CSQ: 18,0\r\n");
+  else if (strcmp(c, "+CCLK?") == 0)
+    strcat(out, "\r\n+CCLK: \"26/10/18,12:00:00+08\"\r\n");
+  else if (strcmp(c, "+CIPQSEND=1") == 0)
+    mdm.qsend = 1;
+  else if (strcmp(c, "+CIPSTATUS") == 0)
+    strcat(post, mdm.connected ? "\r\nSTATE: CONNECT OK\r\n" :
+                 mdm.connecting ? "\r\nSTATE: TCP CONNECTING\r\n" :
+                 mdm.gprs ? "\r\nSTATE: IP STATUS\r\n" : "\r\nSTATE: IP INITIAL\r\n");
+  else if (strcmp(c, "+CIPSHUT") == 0)
+    {
+    mdm.gprs = mdm.connecting = mdm.connected = 0;
+    strcat(out, "\r\nSHUT OK\r\n");
+    return 1;
+    }
+  else if (strcmp(c, "+CIICR") == 0)
+    {
+    mdm.gprs = 1;
+    *delay += cfg.gprsdelay;
+    }
+  else if (strcmp(c, "+CIFSR") == 0)
+    {
+    if (!mdm.gprs) return -1;
+    strcat(out, "\r\n10.1.2.3\r\n");
+    return 1;
+    }
+  else if (strncmp(c, "+CIPSTART=", 10) == 0)
+    {
+    if (!mdm.gprs || mdm.connecting || mdm.connected) return -1;
+    mdm.connecting = 1;
+    emu_act_add(emu_now + cfg.respdelay + cfg.conndelay, ACT_CONNECT, 0, NULL);
+    }
+  else if (strcmp(c, "+CIPCLOSE") == 0)
+    {
+    if (!mdm.connecting && !mdm.connected) return -1;
+    mdm.connecting = mdm.connected = 0;
+    strcat(out, "\r\nCLOSE OK\r\n");
+    return 1;
+    }
+  else if (strcmp(c, "+CIPSEND") == 0)
+    {
+    if (!mdm.connected) return -1;
+    strcat(out, "> ");
+    mdm.mode = 1;
+    mdm.datalen = 0;
+    return 1;
+    }
+  else if (strncmp(c, "+CMGS=", 6) == 0)
+    {
+    strcat(out, "> ");
+    mdm.mode = 2;
+    mdm.datalen = 0;
+    return 1;
+    }
+  // else: accept
+  return 0;
+  }
+
+static void mdm_line(char *line)
+  {
+  char out[1024], post[128], *c, *n;
+  unsigned long long delay = cfg.respdelay;
+  emu_inject_t *inj;
+  int r = 0;
+
+  emu_log("modem < %s", line);
+  if (cfg.fastloss > 0 && mdm.baud > 9600)
+    {
+    cfg.fastloss--;
+    emu_log("modem: line lost");
+    return;
+    }
+  if ((strncmp(line, "AT", 2) != 0) && (strncmp(line, "at", 2) != 0))
+    return;
+
+  // error injection:
+  for (c = line + 2; c; c = n)
+    {
+    if ((n = strchr(c, ';')) != NULL) n++;
+    if ((*c) && (inj = mdm_inject(c)) != NULL)
+      {
+      inj->cnt--;
+      if (inj->ignore)
+        {
+        emu_log("modem: ignored");
+        return;
+        }
+      mdm_reply(delay, "\r\nERROR\r\n");
+      return;
+      }
+    }
+
+  out[0] = post[0] = 0;
+  for (c = line + 2; c; c = n)
+    {
+    if ((n = strchr(c, ';')) != NULL) *n++ = 0;
+    if ((r = mdm_command(c, out, post, &delay)) != 0)
+      break;
+    }
+  if (r < 0)
+    strcpy(out, "\r\nERROR\r\n");
+  else if (r == 0)
+    strcat(out, "\r\nOK\r\n");
+  strcat(out, post);
+  mdm_reply(delay, out);
+  if (mdm.ipr != mdm.baud)
+    emu_act_add(mdm.busy, ACT_BAUD, mdm.ipr, NULL);
+  }
+
+// Modem receives a character from the UART TX line:
+static void mdm_rx(unsigned char c, unsigned long baud)
+  {
+  char s[2];
+
+  if (!mdm.on || !mdm.ready)
+    return;
+  if (mdm.baud == 0)
+    {
+    mdm.baud = baud; // autobaud sync
+    emu_log("modem: autobaud %lu", baud);
+    }
+  if (!emu_baud_match(baud, mdm.baud))
+    {
+    mdm.linelen = 0; // noise, the modem waits for the next "AT"
+    return;
+    }
+
+  if (mdm.mode)
+    {
+    if (c == 0x1a || c == 0x1b)
+      {
+      mdm.data[mdm.datalen] = 0;
+      if (c == 0x1b)
+        emu_log("modem: send aborted");
+      else if (mdm.mode == 1)
+        {
+        char r[32];
+        if (mdm.qsend)
+          sprintf(r, "\r\nDATA ACCEPT:%d\r\n", mdm.datalen);
+        else
+          strcpy(r, "\r\nSEND OK\r\n");
+        mdm_reply(cfg.respdelay, r);
+        srv_rx(mdm.data, mdm.datalen);
+        }
+      else
+        {
+        emu_log("SMS > [%d] %s", mdm.datalen, mdm.data);
+        emu_sms_cnt++;
+        if (mdm.datalen > emu_sms_max) emu_sms_max = mdm.datalen;
+        if (mdm.datalen > 160) emu_sms_over++;
+        mdm_reply(2 * NS_S, "\r\n+CMGS: 12\r\n\r\nOK\r\n");
+        }
+      mdm.mode = 0;
+      }
+    else if (mdm.datalen < (int)sizeof(mdm.data) - 1)
+      mdm.data[mdm.datalen++] = c;
+    return;
+    }
+
+  if (mdm.echo)
+    {
+    s[0] = c;
+    s[1] = 0;
+    mdm_puts(s);
+    }
+  if (c == '\r')
+    {
+    mdm.line[mdm.linelen] = 0;
+    if (mdm.linelen > 0)
+      mdm_line(mdm.line);
+    mdm.linelen = 0;
+    }
+  else if ((c != '\n') && (mdm.linelen < (int)sizeof(mdm.line) - 1))
+    mdm.line[mdm.linelen++] = c;
+  }
+
+static void emu_action(emu_act_t *a)
+  {
+  char buf[400];
+
+  switch (a->type)
+    {
+    case ACT_OUT:
+      mdm_puts(a->text);
+      break;
+    case ACT_BAUD:
+      mdm.baud = a->arg;
+      emu_log("modem: rate %lu", mdm.baud);
+      break;
+    case ACT_BOOT:
+      mdm.ready = 1;
+      if (mdm.baud)
+        mdm_puts("\r\nRDY\r\n\r\n+CFUN: 1\r\n\r\n+CPIN: READY\r\n\r\nCall Ready\r\n");
+      break;
+    case ACT_CONNECT:
+      if (!mdm.connecting) break;
+      mdm.connecting = 0;
+      mdm.connected = 1;
+      srv_connect();
+      mdm_puts("\r\nCONNECT OK\r\n");
+      break;
+    case ACT_SMS:
+      if (!mdm.ready) break;
+      sprintf(buf, "\r\n+CMT: \"%s\",\"\",\"26/10/18,12:00:00+08\",145,4,0,0,"
+                   "\"+491770610000\",145,%d\r\n%s\r\n",
+              par_get(PARAM_REGPHONE), (int) strlen(a->text), a->text);
+      emu_log("SMS < %s", a->text);
+      mdm_puts(buf);
+      break;
+    case ACT_SRVMSG:
+      if (!mdm.connected) break;
+      mdm_puts(a->text);
+      break;
+    case ACT_SRVINJECT:
+      srv_inject(a->text);
+      break;
+    case ACT_CLOSE:
+      if (!mdm.connected) break;
+      emu_log("server: close");
+      mdm.connected = 0;
+      srv_connect();
+      mdm_puts("\r\nCLOSED\r\n");
+      break;
+    case ACT_ERROR:
+      // like a CAN handler in high_isr:
+      emu_log("firmware: error alert %s", a->text);
+      net_req_notification_error(atoi(a->text), 0);
+      break;
+    }
+  }
+
+static void emu_uart_txstart(void)
+  {
+  unsigned char rd;
+
+  if (emu_txbusy || !PIE1bits.TXIE || !INTCONbits.GIE ||
+      emu_uart_statusreg.UARTIntTxBufferEmpty)
+    return;
+  rd = vUARTIntTxBufRdPtr;
+  emu_pir1reg.TXIF = 1;
+  emu_pir1reg.RCIF = 0;
+  low_isr();
+  emu_pir1reg.TXIF = 0;
+  if (vUARTIntTxBufRdPtr != rd)
+    {
+    emu_txbusy = 1;
+    emu_txbyte = TXREG;
+    emu_txbaud = emu_host_baud();
+    emu_txdone = emu_now + emu_chartime(emu_txbaud);
+    }
+  }
+
+static void emu_uart_rxdone(void)
+  {
+  unsigned char c = emu_rxq[emu_rxqrd].c;
+  int ok = emu_baud_match(emu_rxq[emu_rxqrd].baud, emu_host_baud());
+
+  emu_rxqrd = (emu_rxqrd + 1) % EMU_RXQ;
+  emu_rxqlen--;
+  emu_uart_rx++;
+  RCREG = ok ? c : 0xff;
+  RCSTAbits.FERR = !ok;
+  emu_pir1reg.RCIF = 1;
+  emu_pir1reg.TXIF = 0;
+  low_isr();
+  emu_pir1reg.RCIF = 0;
+  RCSTAbits.FERR = 0;
+  }
+
+// Watch the firmware state:
+static struct
+  {
+  unsigned char state, serverok;
+  unsigned int tlogin;
+  unsigned long long tsetup;            // connection setup since
+  unsigned long bsetup;                 // UART bytes at setup start
+  double t_ready;                       // first READY [s]
+  int hardresets;
+  int logins;
+  double t_login[8];                    // setup time per login [s]
+  unsigned long b_login[8];             // UART bytes per login
+  int fw_updates;                       // net_conn_tlogin updates
+  unsigned int fw_tlogin[8];
+  } emu_watch_s;
+
+static const char *emu_statename(unsigned char s)
+  {
+  switch (s)
+    {
+    case NET_STATE_FIRSTRUN: return "FIRSTRUN";
+    case NET_STATE_START: return "START";
+    case NET_STATE_SOFTRESET: return "SOFTRESET";
+    case NET_STATE_HARDRESET: return "HARDRESET";
+    case NET_STATE_HARDSTOP: return "HARDSTOP";
+    case NET_STATE_HARDSTOP2: return "HARDSTOP2";
+    case NET_STATE_STOP: return "STOP";
+    case NET_STATE_DOINIT: return "DOINIT";
+    case NET_STATE_DOINIT2: return "DOINIT2";
+    case NET_STATE_DOINIT3: return "DOINIT3";
+    case NET_STATE_DOBAUD: return "DOBAUD";
+    case NET_STATE_DOBAUDFAIL: return "DOBAUDFAIL";
+    case NET_STATE_READY: return "READY";
+    case NET_STATE_COPS: return "COPS";
+    case NET_STATE_COPSSETTLE: return "COPSSETTLE";
+    case NET_STATE_COPSWAIT: return "COPSWAIT";
+    case NET_STATE_COPSWDONE: return "COPSWDONE";
+    case NET_STATE_DONETINIT: return "DONETINIT";
+    case NET_STATE_NETINITP: return "NETINITP";
+    case NET_STATE_NETINITCP: return "NETINITCP";
+    case NET_STATE_DONETINITC: return "DONETINITC";
+    case NET_STATE_DIAGMODE: return "DIAGMODE";
+    default: return "?";
+    }
+  }
+
+static void emu_watch(void)
+  {
+  unsigned long bytes = emu_uart_tx + emu_uart_rx;
+
+  if (net_state != emu_watch_s.state)
+    {
+    emu_watch_s.state = net_state;
+    emu_log("net: state %s, %lu baud", emu_statename(net_state), emu_host_baud());
+    if (net_state == NET_STATE_HARDRESET)
+      emu_watch_s.hardresets++;
+    if ((net_state == NET_STATE_READY) && (emu_watch_s.t_ready == 0))
+      {
+      emu_watch_s.t_ready = emu_now / 1e9;
+      }
+    }
+  if (net_msg_serverok != emu_watch_s.serverok)
+    {
+    emu_watch_s.serverok = net_msg_serverok;
+    if (net_msg_serverok)
+      {
+      if (emu_watch_s.logins < 8)
+        {
+        emu_watch_s.t_login[emu_watch_s.logins] = (emu_now - emu_watch_s.tsetup) / 1e9;
+        emu_watch_s.b_login[emu_watch_s.logins] = bytes - emu_watch_s.bsetup;
+        }
+      emu_watch_s.logins++;
+      emu_log("net: server login #%d", emu_watch_s.logins);
+      }
+    else
+      {
+      emu_watch_s.tsetup = emu_now;
+      emu_watch_s.bsetup = bytes;
+      emu_log("net: server logout");
+      }
+    }
+  if (net_conn_tlogin != emu_watch_s.tlogin)
+    {
+    emu_watch_s.tlogin = net_conn_tlogin;
+    if (net_conn_tlogin && (emu_watch_s.fw_updates < 8))
+      emu_watch_s.fw_tlogin[emu_watch_s.fw_updates++] = net_conn_tlogin;
+    }
+  }
+
+static void emu_advance(unsigned long long ns)
+  {
+  unsigned long long end, t;
+  int k;
+
+  if (emu_hw)
+    return;
+  emu_hw = 1;
+  end = emu_now + ns;
+  emu_pwrkey();
+  for (;;)
+    {
+    emu_uart_txstart();
+    t = end;
+    if (emu_txbusy && (emu_txdone < t))
+      t = emu_txdone;
+    if (emu_rxqlen && PIE1bits.RCIE && (emu_rxq[emu_rxqrd].due < t))
+      t = emu_rxq[emu_rxqrd].due;
+    k = emu_act_next();
+    if ((k >= 0) && (emu_act[k].due < t))
+      t = emu_act[k].due;
+    emu_timer0(t - emu_now);
+    emu_now = t;
+
+    if (emu_txbusy && (emu_txdone <= t))
+      {
+      emu_txbusy = 0;
+      emu_uart_tx++;
+      mdm_rx(emu_txbyte, emu_txbaud);
+      }
+    else if (emu_rxqlen && PIE1bits.RCIE && (emu_rxq[emu_rxqrd].due <= t))
+      emu_uart_rxdone();
+    else if ((k >= 0) && (emu_act[k].due <= t))
+      {
+      emu_act_t a = emu_act[k];
+      emu_act[k].type = -1;
+      emu_action(&a);
+      }
+    else
+      break;
+    }
+  emu_hw = 0;
+  emu_watch();
+  }
+
+volatile TXSTAbits_t *emu_txsta(void)
+  {
+  if (!emu_hw) emu_advance(EMU_POLL_NS);
+  emu_txstareg.TRMT = !emu_txbusy;
+  return &emu_txstareg;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Emulated OVMS server
+//
+
+static struct
+  {
+  int login;
+  RC4_CTX1 rx1, tx1;
+  RC4_CTX2 rx2, tx2;
+  char line[1024];
+  int linelen;
+  unsigned long msgs;                   // messages received
+  unsigned long pongs;                  // "MP-0 a" received
+  unsigned long errors;                 // "MP-0 PE" received
+  } srv;
+
+static void srv_connect(void)
+  {
+  srv.login = 0;
+  srv.linelen = 0;
+  }
+
+static void srv_send(const char *line)
+  {
+  char buf[320];
+
+  sprintf(buf, "+IPD,%d:%s\r\n", (int) strlen(line) + 2, line);
+  emu_act_add(emu_now + cfg.srvdelay, ACT_SRVMSG, 0, buf);
+  }
+
+static void srv_sendmsg(const char *msg)
+  {
+  unsigned char enc[200], b64[280];
+  int len = strlen(msg);
+
+  memcpy(enc, msg, len);
+  RC4_crypt(&srv.tx1, &srv.tx2, enc, len);
+  *base64encode(enc, len, b64) = 0;
+  emu_log("server > %s", msg);
+  srv_send((char*) b64);
+  }
+
+static void srv_inject(const char *msg)
+  {
+  char buf[200];
+
+  if (!mdm.connected || !srv.login)
+    {
+    emu_log("server: not connected, \"%s\" dropped", msg);
+    return;
+    }
+  snprintf(buf, sizeof(buf), "MP-0 %s", msg);
+  srv_sendmsg(buf);
+  }
+
+static void srv_login(char *msg)
+  {
+  static char stoken[] = "EMUSERVERTOKEN01234567";
+  char *ctoken, *cdigest, *pass = par_get(PARAM_SERVERPASS);
+  unsigned char d[MD5_SIZE], b64[40], key[64], c;
+  char reply[128];
+  int k;
+
+  // MP-C 0 <token> <digest> <vehicleid>
+  ctoken = msg + 7;
+  if ((cdigest = strchr(ctoken, ' ')) == NULL) return;
+  *cdigest++ = 0;
+  if ((msg = strchr(cdigest, ' ')) != NULL) *msg = 0;
+  hmac_md5((unsigned char*) ctoken, strlen(ctoken), (unsigned char*) pass, strlen(pass), d);
+  *base64encode(d, MD5_SIZE, b64) = 0;
+  if (strcmp((char*) b64, cdigest) != 0)
+    {
+    emu_log("server: invalid client digest");
+    return;
+    }
+
+  hmac_md5((unsigned char*) stoken, strlen(stoken), (unsigned char*) pass, strlen(pass), d);
+  *base64encode(d, MD5_SIZE, b64) = 0;
+  sprintf(reply, "MP-S 0 %s %s", stoken, b64);
+  srv_send(reply);
+
+  sprintf((char*) key, "%s%s", stoken, ctoken);
+  hmac_md5(key, strlen((char*) key), (unsigned char*) pass, strlen(pass), d);
+  RC4_setup(&srv.rx1, &srv.rx2, d, MD5_SIZE);
+  RC4_setup(&srv.tx1, &srv.tx2, d, MD5_SIZE);
+  for (k = 0; k < 1024; k++)
+    {
+    c = 0; RC4_crypt(&srv.rx1, &srv.rx2, &c, 1);
+    c = 0; RC4_crypt(&srv.tx1, &srv.tx2, &c, 1);
+    }
+  srv.login = 1;
+  }
+
+static void srv_line(char *line)
+  {
+  unsigned char msg[1024];
+  int len;
+
+  if (!srv.login)
+    {
+    if (strncmp(line, "MP-C 0 ", 7) == 0)
+      srv_login(line);
+    return;
+    }
+  len = base64decode((unsigned char*) line, msg);
+  RC4_crypt(&srv.rx1, &srv.rx2, msg, len);
+  msg[len] = 0;
+  srv.msgs++;
+  if (strcmp((char*) msg, "MP-0 a") == 0)
+    srv.pongs++;
+  else if (strncmp((char*) msg, "MP-0 PE", 7) == 0)
+    srv.errors++;
+  emu_log("server < %s", msg);
+  }
+
+static void srv_rx(const char *data, int len)
+  {
+  for (; len > 0; data++, len--)
+    {
+    if (*data == '\n')
+      {
+      srv.line[srv.linelen] = 0;
+      if (srv.linelen > 0)
+        srv_line(srv.line);
+      srv.linelen = 0;
+      }
+    else if ((*data != '\r') && (srv.linelen < (int)sizeof(srv.line) - 1))
+      srv.line[srv.linelen++] = *data;
+    }
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Runs, options & scenarios
+//
+
+typedef struct
+  {
+  const char *name;
+  int (*check)(void);                   // 1 = passed
+  const char *args[16];
+  } emu_test_t;
+
+static int emu_injectopt(const char *s, int ignore)
+  {
+  emu_inject_t *inj;
+  const char *p;
+
+  if (cfg.injects == EMU_INJECT) return 0;
+  inj = &cfg.inject[cfg.injects++];
+  p = strchr(s, ',');
+  snprintf(inj->cmd, sizeof(inj->cmd), "%.*s", p ? (int)(p - s) : (int) strlen(s), s);
+  inj->cnt = p ? atoi(p + 1) : 1;
+  inj->ignore = ignore;
+  return 1;
+  }
+
+static int emu_timedopt(const char *s, int type)
+  {
+  const char *p = strchr(s, ',');
+
+  if (!p) return 0;
+  emu_act_add((unsigned long long)(atof(s) * NS_S), type, 0, p + 1);
+  return 1;
+  }
+
+static void emu_usage(void)
+  {
+  fprintf(stderr,
+    "usage: netemu [-t sec] [-d ms] [-g ms] [-p ms] [-c ms] [-l ms] [-b baud]\n"
+    "              [-F n] [-e cmd[,n]] [-x cmd[,n]] [-s sec,text] [-m sec,msg]\n"
+    "              [-k sec] [-r sec,code] [-v]\n"
+    "       netemu test\n");
+  exit(2);
+  }
+
+static int emu_options(int argc, char **argv, unsigned long long *runtime)
+  {
+  int c;
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.respdelay = 20 * NS_MS;
+  cfg.regdelay = 3000 * NS_MS;
+  cfg.gprsdelay = 1500 * NS_MS;
+  cfg.conndelay = 500 * NS_MS;
+  cfg.srvdelay = 100 * NS_MS;
+  cfg.baud = 9600;
+  *runtime = 120 * NS_S;
+  for (c = 0; c < EMU_ACTS; c++)
+    emu_act[c].type = -1;
+
+  optind = 1;
+  while ((c = getopt(argc, argv, "t:d:g:p:c:l:b:F:e:x:s:m:k:r:v")) != -1)
+    {
+    switch (c)
+      {
+      case 't': *runtime = (unsigned long long)(atof(optarg) * NS_S); break;
+      case 'd': cfg.respdelay = atol(optarg) * NS_MS; break;
+      case 'g': cfg.regdelay = atol(optarg) * NS_MS; break;
+      case 'p': cfg.gprsdelay = atol(optarg) * NS_MS; break;
+      case 'c': cfg.conndelay = atol(optarg) * NS_MS; break;
+      case 'l': cfg.srvdelay = atol(optarg) * NS_MS; break;
+      case 'b': cfg.baud = atol(optarg); break;
+      case 'F': cfg.fastloss = atoi(optarg); break;
+      case 'e': if (!emu_injectopt(optarg, 0)) return 0; break;
+      case 'x': if (!emu_injectopt(optarg, 1)) return 0; break;
+      case 's': if (!emu_timedopt(optarg, ACT_SMS)) return 0; break;
+      case 'm': if (!emu_timedopt(optarg, ACT_SRVINJECT)) return 0; break;
+      case 'k': emu_act_add((unsigned long long)(atof(optarg) * NS_S), ACT_CLOSE, 0, NULL); break;
+      case 'r': if (!emu_timedopt(optarg, ACT_ERROR)) return 0; break;
+      case 'v': emu_verbose = 1; break;
+      default: return 0;
+      }
+    }
+  return (optind == argc);
+  }
+
+static void emu_run(unsigned long long runtime)
+  {
+  // Parameters:
+  strcpy(EEparam[PARAM_REGPHONE], "+4912345678");
+  strcpy(EEparam[PARAM_MODULEPASS], "OVMS");
+  strcpy(EEparam[PARAM_NOTIFIES], "SMS,IP");
+  strcpy(EEparam[PARAM_SERVERIP], "127.0.0.1");
+  strcpy(EEparam[PARAM_GPRSAPN], "internet");
+  strcpy(EEparam[PARAM_VEHICLEID], "EMU");
+  strcpy(EEparam[PARAM_SERVERPASS], "EMUPASS");
+
+  mdm.ipr = cfg.baud;
+  emu_end = runtime;
+  if (setjmp(emu_exit) == 0)
+    ovms_main();
+  }
+
+static void emu_report(void)
+  {
+  int k;
+
+  printf("  run:       %.1f s%s%s\n", emu_now / 1e9,
+         emu_exitreason ? ", stopped: " : "", emu_exitreason ? emu_exitreason : "");
+  if (emu_watch_s.t_ready)
+    printf("  READY:     %.1f s after power on, UART %lu baud\n",
+           emu_watch_s.t_ready, emu_host_baud());
+  else
+    printf("  READY:     not reached, state %s\n", emu_statename(net_state));
+  for (k = 0; (k < emu_watch_s.logins) && (k < 8); k++)
+    printf("  login #%d:  %.1f s, %lu UART bytes (from %s)\n", k + 1,
+           emu_watch_s.t_login[k], emu_watch_s.b_login[k],
+           k ? "connection loss" : "power on");
+  printf("  firmware:  net_conn_tready %u s, net_conn_tlogin %u s, net_conn_bytes %lu\n",
+         net_conn_tready, net_conn_tlogin, net_conn_bytes);
+  printf("  UART:      %lu bytes TX, %lu bytes RX\n", emu_uart_tx, emu_uart_rx);
+  printf("  server:    %lu messages, %lu pongs, %lu error alerts\n",
+         srv.msgs, srv.pongs, srv.errors);
+  printf("  SMS:       %d sent, max %d chars, %d over 160\n",
+         emu_sms_cnt, emu_sms_max, emu_sms_over);
+  }
+
+// Scenario checks:
+
+static int emu_check_login(void)
+  {
+  return emu_watch_s.t_ready && emu_watch_s.logins == 1 &&
+         net_conn_tready && net_conn_tlogin && net_conn_bytes && srv.msgs;
+  }
+
+static int emu_check_relogin(void)
+  {
+  // net_conn_tlogin measured for both logins, the second one is faster:
+  return emu_watch_s.logins == 2 && emu_watch_s.fw_updates == 2 &&
+         emu_watch_s.fw_tlogin[1] < emu_watch_s.fw_tlogin[0];
+  }
+
+static int emu_check_ping(void)
+  {
+  return emu_watch_s.logins == 1 && srv.pongs == 1;
+  }
+
+static int emu_check_error(void)
+  {
+  return emu_watch_s.logins == 1 && srv.errors == 1;
+  }
+
+static int emu_check_sms(void)
+  {
+  return emu_watch_s.logins == 1 && emu_sms_cnt > 0 && emu_sms_over == 0;
+  }
+
+
+#ifdef OVMS_FASTBAUD
+static int emu_check_fast(void)
+  {
+  return emu_watch_s.logins == 1 && net_baud_fast && emu_host_baud() > 9615;
+  }
+
+static int emu_check_fallback(void)
+  {
+  return emu_watch_s.logins == 1 && !net_baud_fast && net_baud_failed;
+  }
+
+static int emu_check_retry(void)
+  {
+  // HARDRESET clears net_baud_failed, the next START switches:
+  return emu_watch_s.logins == 1 && emu_watch_s.hardresets > 0 && net_baud_fast;
+  }
+#endif // OVMS_FASTBAUD
+
+static emu_test_t emu_tests[] =
+  {
+  { "login",        emu_check_login,    { "-t", "90" } },
+  { "slow-modem",   emu_check_login,    { "-t", "150", "-d", "400", "-g", "20000", "-p", "8000", "-c", "3000", "-l", "1500" } },
+  { "gprs-error",   emu_check_login,    { "-t", "120", "-e", "+CIICR" } },
+  { "relogin",      emu_check_relogin,  { "-t", "150", "-k", "90" } },
+  { "ping",         emu_check_ping,     { "-t", "120", "-m", "80,A" } },
+  { "sms-stat",     emu_check_sms,      { "-t", "120", "-s", "80,STAT" } },
+  { "sms-diag",     emu_check_sms,      { "-t", "120", "-s", "80,DIAG" } },
+  { "error-online", emu_check_error,    { "-t", "120", "-r", "80,42" } },
+  { "error-offline",emu_check_error,    { "-t", "120", "-r", "5,42" } },
+#ifdef OVMS_FASTBAUD
+  { "baud-fast",    emu_check_fast,     { "-t", "90" } },
+  { "baud-modem57", emu_check_fast,     { "-t", "90", "-b", "57600" } },
+  { "baud-refused", emu_check_fallback, { "-t", "90", "-e", "+IPR=57600" } },
+  { "baud-retry",   emu_check_retry,    { "-t", "180", "-e", "+IPR=57600", "-x", "+CREG=1,15" } },
+  { "baud-lost",    emu_check_fast,     { "-t", "120", "-F", "2" } },
+#endif // OVMS_FASTBAUD
+  { NULL }
+  };
+
+static int emu_test(void)
+  {
+  emu_test_t *t;
+  char *argv[16];
+  int argc, status, failed = 0;
+  unsigned long long runtime;
+  pid_t pid;
+
+  for (t = emu_tests; t->name; t++)
+    {
+    fflush(stdout);
+    if ((pid = fork()) == 0)
+      {
+      // fresh firmware state per scenario:
+      argv[0] = "netemu";
+      for (argc = 1; t->args[argc-1]; argc++)
+        argv[argc] = (char*) t->args[argc-1];
+      argv[argc] = NULL;
+      if (!emu_options(argc, argv, &runtime))
+        exit(2);
+      emu_run(runtime);
+      status = t->check() ? 0 : 1;
+      printf("%s: %s\n", status ? "FAIL" : "PASS", t->name);
+      if (status)
+        emu_report();
+      fflush(stdout);
+      exit(status);
+      }
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status))
+      failed++;
+    }
+  printf("%d scenario(s) failed\n", failed);
+  return failed ? 1 : 0;
+  }
+
+int main(int argc, char **argv)
+  {
+  unsigned long long runtime;
+
+  if ((argc == 2) && (strcmp(argv[1], "test") == 0))
+    return emu_test();
+
+  if (!emu_options(argc, argv, &runtime))
+    emu_usage();
+  emu_run(runtime);
+  printf("netemu (%s):\n",
+#ifdef OVMS_FASTBAUD
+         "OVMS_FASTBAUD"
+#else
+         "9600 baud"
+#endif
+         );
+  emu_report();
+  return 0;
+  }
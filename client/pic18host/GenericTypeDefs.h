@@ -0,0 +1,32 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * pic18host: host (gcc) replacement for the Microchip GenericTypeDefs.h
+ *  (sizes as on the PIC18: WORD = 16 bit, DWORD = 32 bit)
+ *
+ */
+
+#ifndef __PIC18HOST_GENERICTYPEDEFS_H
+#define __PIC18HOST_GENERICTYPEDEFS_H
+
+typedef enum _BOOL { FALSE = 0, TRUE } BOOL;
+
+typedef unsigned char   BYTE;
+typedef unsigned short  WORD;
+typedef unsigned int    DWORD;
+
+typedef char            CHAR;
+typedef signed char     INT8;
+typedef short           INT16;
+typedef int             INT32;
+typedef int             INT;
+
+typedef unsigned char   UINT8;
+typedef unsigned short  UINT16;
+typedef unsigned int    UINT32;
+typedef unsigned int    UINT;
+
+#endif // __PIC18HOST_GENERICTYPEDEFS_H
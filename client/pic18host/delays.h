@@ -0,0 +1,18 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * pic18host: host (gcc) replacement for the C18 delays.h
+ *  (TCY = 200 ns at 20 MHz)
+ *
+ */
+
+#ifndef __PIC18HOST_DELAYS_H
+#define __PIC18HOST_DELAYS_H
+
+extern void emu_delay_us(unsigned long us);
+#define Delay1KTCYx(n) emu_delay_us(200UL * (n))
+
+#endif // __PIC18HOST_DELAYS_H
@@ -0,0 +1,235 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * pic18host: host (gcc) replacement for the C18 processor header
+ *
+ * Provides the C18 storage qualifiers, the SFRs used by the modem and
+ * network code (net.c, net_msg.c, net_sms.c, utils.c, params.c, ovms.c,
+ * UARTIntC.c) and the C18 library functions they call, so these modules
+ * can be compiled into host tools like netemu.
+ *
+ * SFRs with hardware side effects (timer flags, UART transmitter status,
+ * EEPROM write cycle) are accessed through functions of the host tool
+ * (emu_*), so the busy-wait loops of the firmware advance the emulated
+ * time.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __PIC18HOST_P18F2680_H
+#define __PIC18HOST_P18F2680_H
+
+#include <stdio.h>
+#include <string.h>
+
+// C18 storage qualifiers:
+#define rom
+#define ram
+#define far
+#define near
+
+// Plain SFRs:
+extern volatile unsigned char TMR0L, TMR0H, T0CON;
+extern volatile unsigned char TMR2, PR2, T2CON;
+extern volatile unsigned char SPBRG, SPBRGH, TXREG, RCREG;
+extern volatile unsigned char TRISB, RCON, INTCON;
+extern volatile unsigned char EECON1, EECON2, EEADR, EEADRH;
+
+// EEDATA performs the read/write cycle requested in EECON1:
+#define EEDATA (*emu_eedata())
+extern volatile unsigned char *emu_eedata(void);
+
+typedef struct {
+  unsigned NOT_BOR:1;
+  unsigned NOT_POR:1;
+  unsigned NOT_PD:1;
+  unsigned NOT_TO:1;
+  unsigned NOT_RI:1;
+  unsigned :2;
+  unsigned IPEN:1;
+} RCONbits_t;
+#define RCONbits (*((volatile RCONbits_t*)&RCON))
+
+typedef struct {
+  unsigned RBIF:1;
+  unsigned INT0IF:1;
+  unsigned TMR0IF:1;
+  unsigned RBIE:1;
+  unsigned INT0IE:1;
+  unsigned TMR0IE:1;
+  unsigned PEIE:1;              // = GIEL
+  unsigned GIE:1;               // = GIEH
+} INTCONbits_t;
+#define INTCONbits (*((volatile INTCONbits_t*)&INTCON))
+#define GIEL PEIE
+#define GIEH GIE
+
+typedef struct {
+  unsigned RD:1;
+  unsigned WR:1;
+  unsigned WREN:1;
+  unsigned WRERR:1;
+  unsigned FREE:1;
+  unsigned :1;
+  unsigned CFGS:1;
+  unsigned EEPGD:1;
+} EECON1bits_t;
+#define EECON1bits (*((volatile EECON1bits_t*)emu_eecon1()))
+extern volatile unsigned char *emu_eecon1(void);
+
+typedef struct {
+  unsigned :6;
+  unsigned STKUNF:1;
+  unsigned STKFUL:1;
+} STKPTRbits_t;
+extern volatile STKPTRbits_t STKPTRbits;
+
+typedef struct {
+  unsigned :1;
+  unsigned TMR2IF:1;
+  unsigned :2;
+  unsigned TXIF:1;
+  unsigned RCIF:1;
+  unsigned :2;
+} PIR1bits_t;
+#define PIR1bits (*emu_pir1())
+extern volatile PIR1bits_t *emu_pir1(void);
+
+typedef struct {
+  unsigned :4;
+  unsigned TXIE:1;
+  unsigned RCIE:1;
+  unsigned :2;
+} PIE1bits_t;
+extern volatile PIE1bits_t PIE1bits;
+
+typedef struct {
+  unsigned :4;
+  unsigned TXIP:1;
+  unsigned RCIP:1;
+  unsigned :2;
+} IPR1bits_t;
+extern volatile IPR1bits_t IPR1bits;
+
+typedef struct {
+  unsigned TX9D:1;
+  unsigned TRMT:1;
+  unsigned BRGH:1;
+  unsigned SENDB:1;
+  unsigned SYNC:1;
+  unsigned TXEN:1;
+  unsigned TX9:1;
+  unsigned CSRC:1;
+} TXSTAbits_t;
+#define TXSTAbits (*emu_txsta())
+extern volatile TXSTAbits_t *emu_txsta(void);
+
+typedef struct {
+  unsigned RX9D:1;
+  unsigned OERR:1;
+  unsigned FERR:1;
+  unsigned ADDEN:1;
+  unsigned CREN:1;
+  unsigned SREN:1;
+  unsigned RX9:1;
+  unsigned SPEN:1;
+} RCSTAbits_t;
+extern volatile RCSTAbits_t RCSTAbits;
+
+typedef struct {
+  unsigned ABDEN:1;
+  unsigned WUE:1;
+  unsigned :1;
+  unsigned BRG16:1;
+  unsigned :4;
+} BAUDCONbits_t;
+extern volatile BAUDCONbits_t BAUDCONbits;
+
+typedef struct {
+  unsigned RB0:1;
+  unsigned :7;
+} PORTBbits_t;
+extern volatile PORTBbits_t PORTBbits;
+
+typedef struct {
+  unsigned :4;
+  unsigned RC4:1;
+  unsigned RC5:1;
+  unsigned :2;
+} PORTCbits_t;
+extern volatile PORTCbits_t PORTCbits;
+
+typedef struct {
+  unsigned :6;
+  unsigned TRISC6:1;
+  unsigned TRISC7:1;
+} TRISCbits_t;
+extern volatile TRISCbits_t TRISCbits;
+
+// Instructions:
+extern void emu_clrwdt(void);
+#define ClrWdt() emu_clrwdt()
+#define Nop()
+
+// C18 library (string.h, stdlib.h):
+static inline int memcmppgm2ram(void *s1, const void *s2, size_t n)
+  {
+  return memcmp(s1, s2, n);
+  }
+static inline char *strcatpgm2ram(char *s1, const char *s2)
+  {
+  return strcat(s1, s2);
+  }
+static inline signed char strcmppgm2ram(const char *s1, const char *s2)
+  {
+  int r = strcmp(s1, s2);
+  return (r < 0) ? -1 : (r > 0);
+  }
+static inline char *strstrrampgm(const char *s1, const char *s2)
+  {
+  return strstr(s1, s2);
+  }
+static inline char *strupr(char *s)
+  {
+  char *p;
+  for (p = s; *p; p++)
+    if (*p >= 'a' && *p <= 'z')
+      *p -= 'a' - 'A';
+  return s;
+  }
+static inline char *itoa(int value, char *s)
+  {
+  sprintf(s, "%d", (short) value); // C18 int = 16 bit
+  return s;
+  }
+static inline char *ltoa(long value, char *s)
+  {
+  sprintf(s, "%ld", value);
+  return s;
+  }
+static inline char *ultoa(unsigned long value, char *s)
+  {
+  sprintf(s, "%lu", value);
+  return s;
+  }
+
+#endif // __PIC18HOST_P18F2680_H
@@ -0,0 +1,12 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * pic18host: host (gcc) replacement for the C18 processor header
+ *  (PIC18F2685 = PIC18F2680 with more program memory)
+ *
+ */
+
+#include "p18f2680.h"
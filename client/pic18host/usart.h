@@ -0,0 +1,10 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * pic18host: host (gcc) replacement for the C18 usart.h
+ *  (the firmware uses the UARTIntC module instead of the library)
+ *
+ */
@@ -0,0 +1,170 @@
+/*******************************************************************************
+ *
+ * OVMS -- Open Vehicles Monitoring System
+ *  https://www.openvehicles.com/
+ *  https://github.com/openvehicles
+ *
+ * smsbench: host benchmark of the firmware SMS command dispatch
+ * 	(net_sms_in + vehicle_fn_smshandler / vehicle_fn_smsextensions lookups)
+ *
+ * Compares the full compare per table entry (memcmppgm2ram / starts_with)
+ * against net_sms_findcmd, which checks the first character before the
+ * full compare, using the core and Twizy command tables. Checks both find
+ * the same entries and counts the characters read from the tables per
+ * command (the PIC cost is dominated by these program memory reads).
+ *
+ * Usage:
+ *  ./smsbench [iterations]
+ *
+ * Build:
+ *  gcc -O2 -o smsbench smsbench.c
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define NET_SMS_CMDWIDTH 16
+
+// (copied from vehicle/OVMS.X/net_sms.c, default build)
+const char sms_cmdtable[][NET_SMS_CMDWIDTH] =
+  { "3REGISTER?", "1REGISTER", "3PASS?", "2PASS ", "3GPS", "3STAT",
+    "3PARAMS?", "2PARAMS ", "1AP ", "3MODULE?", "2MODULE ", "3VEHICLE?",
+    "2VEHICLE ", "3GPRS?", "2GPRS ", "3GSMLOCK?", "2GSMLOCK", "3SERVER?",
+    "2SERVER ", "3DIAG", "3FEATURES?", "2FEATURE ", "2HOMELINK", "2LOCK",
+    "2UNLOCK", "2VALET", "2UNVALET", "2CHARGEMODE ", "2CHARGESTART",
+    "2CHARGESTOP", "2COOLDOWN", "3VERSION", "3RESET", "3CTP", "3TEMPS",
+    "3HELP", "" };
+
+// (copied from vehicle/OVMS.X/vehicle_twizy.c, default build)
+const char vehicle_twizy_sms_cmdtable[][NET_SMS_CMDWIDTH] =
+  { "2LOCK", "2UNLOCK", "2VALET", "2UNVALET", "3STAT", "3RANGE", "3CA",
+    "3POWER", "3BATT", "3CFG", "3HELP", "" };
+
+const char *testcmds[] =
+  { "STAT", "GPS", "HELP", "CHARGEMODE RANGE", "FEATURE 15 4", "POWER",
+    "CA 80", "CFG PRESET 1", "HELLO WORLD", NULL };
+
+long reads;                           // table characters read
+
+// Old lookup: full compare of each entry (as memcmppgm2ram / starts_with)
+int findcmd_full(const char *cmdtable, const char *command)
+{
+  int k, n;
+
+  for (k = 0; cmdtable[0] != 0; k++, cmdtable += NET_SMS_CMDWIDTH)
+  {
+    n = strlen(cmdtable) - 1;
+    reads += n + 2;
+    if (memcmp(command, cmdtable + 1, n) == 0)
+      return k;
+  }
+  return -1;
+}
+
+// (copied from vehicle/OVMS.X/utils.c)
+int starts_with(const char *s, const char *pfx)
+{
+  while ((*s == *pfx) && (*pfx != 0))
+  {
+    reads++;
+    pfx++;
+    s++;
+  }
+  reads++;
+  return (*pfx == 0);
+}
+
+// (copied from vehicle/OVMS.X/net_sms.c)
+int net_sms_findcmd(const char *cmdtable, const char *command)
+{
+  int k;
+
+  for (k = 0; cmdtable[0] != 0; k++, cmdtable += NET_SMS_CMDWIDTH)
+  {
+    reads += 2;
+    if ((cmdtable[1] == command[0]) && (starts_with(command, cmdtable + 1)))
+      return k;
+  }
+  return -1;
+}
+
+// Dispatch as net_sms_in: core table, then the vehicle handler (premsg)
+// for a core command, or the vehicle extensions for an unknown one.
+// Returns the core index * 100 + vehicle index for checking.
+int dispatch(int mode, const char *command)
+{
+  int (*find)(const char *, const char *) = mode ? net_sms_findcmd : findcmd_full;
+  int k, v;
+
+  k = find(sms_cmdtable[0], command);
+  v = find(vehicle_twizy_sms_cmdtable[0], command);
+  return k * 100 + v;
+}
+
+double bench(int mode, const char *command, long n)
+{
+  clock_t t0, t1;
+  long i;
+  volatile int r = 0;
+
+  t0 = clock();
+  for (i = 0; i < n; i++)
+    r += dispatch(mode, command);
+  t1 = clock();
+  if (t1 == t0)
+    t1++;
+  return (double) (t1 - t0) * 1e9 / CLOCKS_PER_SEC / n;
+}
+
+int main(int argc, char *argv[])
+{
+  long n = (argc > 1) ? atol(argv[1]) : 1000000;
+  long r0, r1;
+  int i;
+
+  if (n <= 0)
+  {
+    fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%-18s %10s %10s %10s %10s\n", "command",
+    "ns full", "ns first", "rd full", "rd first");
+  for (i = 0; testcmds[i] != NULL; i++)
+  {
+    if (dispatch(0, testcmds[i]) != dispatch(1, testcmds[i]))
+    {
+      fprintf(stderr, "ERROR: lookup mismatch for %s\n", testcmds[i]);
+      return 2;
+    }
+    reads = 0;
+    dispatch(0, testcmds[i]);
+    r0 = reads;
+    reads = 0;
+    dispatch(1, testcmds[i]);
+    r1 = reads;
+    printf("%-18s %10.1f %10.1f %10ld %10ld\n", testcmds[i],
+      bench(0, testcmds[i], n), bench(1, testcmds[i], n), r0, r1);
+  }
+  return 0;
+}
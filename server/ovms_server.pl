@@ -313,9 +313,16 @@ sub io_line
     $conns{$fn}{'clienttype'} = $clienttype;
     $conns{$fn}{'lastping'} = time;
 
+    # Binary records offered by the car?
+    my $options = '';
+    if (($clienttype eq 'C')&&(defined $rest)&&($rest =~ /(^|\s)B1(\s|$)/))
+      {
+      $options = ' B1';
+      }
+
     # Send out server welcome message
-    AE::log info => "#$fn $clienttype $vehicleid tx MP-S 0 $servertoken $serverdigest";
-    my $towrite = "MP-S 0 $servertoken $serverdigest\r\n";
+    AE::log info => "#$fn $clienttype $vehicleid tx MP-S 0 $servertoken $serverdigest$options";
+    my $towrite = "MP-S 0 $servertoken $serverdigest$options\r\n";
     $conns{$fn}{'tx'} += length($towrite);
     $hdl->push_write($towrite);
     return if ($hdl->destroyed);
@@ -384,7 +391,19 @@ sub io_line
     # STANDARD PROTOCOL MESSAGE
     #
     my $message = $conns{$fn}{'rxcipher'}->RC4(decode_base64($line));
-    if ($message =~ /^MP-0\s(\S)(.*)/)
+    if ($message =~ /^MP-0\sb(\S)(.*)/s)
+      {
+      # Binary record, translate to text form
+      my ($code,$data) = ($1,&io_bin_decode($2));
+      if (!defined $data)
+        {
+        &io_terminate($fn,$hdl,$vid, "error - Unable to decode binary message - aborting connection");
+        return;
+        }
+      &log($fn, $clienttype, $vid, "rx msg $code $data (binary)");
+      &io_message($fn, $hdl, $conns{$fn}{'vehicleid'}, $vrec, $code, $data);
+      }
+    elsif ($message =~ /^MP-0\s(\S)(.*)/)
       {
       my ($code,$data) = ($1,$2);
       &log($fn, $clienttype, $vid, "rx msg $code $data");
@@ -404,6 +423,64 @@ sub io_line
 
   }
 
+# Decode binary record fields (see net_msg_bin_encode in the car firmware)
+sub io_bin_decode
+  {
+  my ($bin) = @_;
+  my @fields;
+  my $pos = 0;
+  my $len = length($bin);
+
+  while ($pos < $len)
+    {
+    my $t = ord(substr($bin,$pos++,1));
+    if ($t < 0x40)
+      {
+      push @fields, $t;
+      }
+    elsif ($t <= 0x47)
+      {
+      my ($z,$shift,$b) = (0,0,0x80);
+      while ($b & 0x80)
+        {
+        return undef if ($pos >= $len);
+        $b = ord(substr($bin,$pos++,1));
+        $z += ($b & 0x7f) << $shift;
+        $shift += 7;
+        }
+      my $v = ($z & 1) ? -(($z+1)>>1) : ($z>>1);
+      my $dec = $t - 0x40;
+      if ($dec == 0)
+        {
+        push @fields, $v;
+        }
+      else
+        {
+        my $str = sprintf("%0*d",$dec+1,abs($v));
+        substr($str,-$dec,0) = '.';
+        push @fields, ($v < 0) ? "-$str" : $str;
+        }
+      }
+    elsif ($t == 0x48)
+      {
+      push @fields, '';
+      }
+    elsif ($t >= 0x80)
+      {
+      my $l = $t & 0x7f;
+      return undef if ($pos+$l > $len);
+      push @fields, substr($bin,$pos,$l);
+      $pos += $l;
+      }
+    else
+      {
+      return undef;
+      }
+    }
+
+  return join(',',@fields);
+  }
+
 sub io_login
   {
   my ($fn,$hdl,$vehicleid,$clienttype,$rest) = @_;
@@ -1055,6 +1132,46 @@ sub io_message
     return;
     }
 
+  elsif (($m_code eq 'd')&&($m_paranoid == 0))
+    {
+    # Delta message: <code><fieldcount>,<index>,<value>,...
+    # Expand it against the stored record, apps only see full records
+    if ($clienttype ne 'C')
+      {
+      AE::log info => "#$fn $clienttype $vehicleid msg invalid 'd' message from non-Car";
+      return;
+      }
+    my ($d_head,@d_pairs) = split /,/,$data,-1;
+    my ($d_code,$d_count);
+    if ($d_head =~ /^(.)(\d+)$/)
+      {
+      ($d_code,$d_count) = ($1,$2);
+      }
+    if ((!defined $d_count)||((scalar @d_pairs) % 2))
+      {
+      AE::log error => "#$fn $clienttype $vehicleid msg invalid delta '$data'";
+      return;
+      }
+    my $sth = $db->prepare('SELECT m_msg FROM ovms_carmessages WHERE vehicleid=? AND m_code=? AND m_paranoid=0');
+    $sth->execute($vehicleid,$d_code);
+    my $row = $sth->fetchrow_hashref();
+    if (!defined $row)
+      {
+      AE::log error => "#$fn $clienttype $vehicleid msg delta '$d_code' without base record";
+      return;
+      }
+    my @d_fields = split /,/,$row->{'m_msg'},-1;
+    $#d_fields = $d_count-1;
+    while (scalar @d_pairs > 0)
+      {
+      my $d_index = shift @d_pairs;
+      my $d_value = shift @d_pairs;
+      $d_fields[$d_index] = $d_value if ($d_index < $d_count);
+      }
+    $code = $m_code = $d_code;
+    $data = $m_data = join(',',map { defined $_ ? $_ : '' } @d_fields);
+    }
+
   if ($clienttype eq 'C')
     {
     # Kludge: fix to 1.2.0 bug with S messages in performance mode
@@ -47,6 +47,7 @@
  *										tions to unsigned char
  ********************************************************************/
  
+#include "ovms.def" // OVMS_UARTTXRING
 #include "UARTIntC.h"
 
 // target specific file will go here
@@ -57,7 +58,13 @@ volatile struct status vUARTIntStatus;
 		
 // variable definitions
 #if TXON
+#ifdef OVMS_UARTTXRING
+#pragma udata UART_TXBUF
 volatile unsigned char vUARTIntTxBuffer[TX_BUFFER_SIZE];
+#pragma udata
+#else
+volatile unsigned char vUARTIntTxBuffer[TX_BUFFER_SIZE];
+#endif
 volatile unsigned char vUARTIntTxBufDataCnt;
 volatile unsigned char vUARTIntTxBufWrPtr;
 volatile unsigned char vUARTIntTxBufRdPtr;
@@ -68,6 +75,7 @@ volatile unsigned char vUARTIntRxBuffer[RX_BUFFER_SIZE];
 volatile unsigned char vUARTIntRxBufDataCnt;
 volatile unsigned char vUARTIntRxBufWrPtr;
 volatile unsigned char vUARTIntRxBufRdPtr;
+volatile unsigned int vUARTIntRxOverFlowCnt;
 #endif
 
 /*********************************************************************
@@ -101,6 +109,7 @@ void UARTIntInit(void)
 		vUARTIntRxBufDataCnt = 0;
 		vUARTIntRxBufWrPtr = 0;
 		vUARTIntRxBufRdPtr = 0;	
+		vUARTIntRxOverFlowCnt = 0;
 	#endif	
 	    
     /* Initialising BaudRate value */
@@ -275,6 +284,52 @@ unsigned char UARTIntGetChar(unsigned char *chTemp)
 	return 1;
 }
 
+/*********************************************************************
+ * Function:        	unsigned char UARTIntGetBlock(unsigned char*,
+ *						unsigned char, unsigned char)
+ * PreCondition:    	UARTIntInit()function should have been called.
+ * Input:           	buffer, max number of characters, stop character
+ * Output:          	unsigned char
+ *							  number of characters read
+ * Side Effects:    	None
+ * Stack Requirements: 	1 level deep
+ * Overview:        	This function reads up to max characters from
+ *						the receive buffer into the argument buffer,
+ *						ending after the stop character if found.
+ *						The characters are copied without interrupt
+ *						lock, only the data count update is critical.
+ *
+ ********************************************************************/
+unsigned char UARTIntGetBlock(unsigned char *chBuf, unsigned char chMax, unsigned char chStop)
+{
+	unsigned char n, avail;
+
+	avail = vUARTIntRxBufDataCnt;
+	if (avail > chMax)
+		avail = chMax;
+	for (n=0; n<avail; )
+	{
+		chBuf[n] = vUARTIntRxBuffer[vUARTIntRxBufRdPtr];
+		vUARTIntRxBufRdPtr++;
+		if(vUARTIntRxBufRdPtr == RX_BUFFER_SIZE)
+			vUARTIntRxBufRdPtr = 0;
+		if (chBuf[n++] == chStop)
+			break;
+	}
+	if (n == 0)
+		return 0;
+
+	//critical code, disabling interrupts here keeps the
+	//data count and status flags proper.
+	PIE1bits.RCIE = 0;
+	vUARTIntStatus.UARTIntRxBufferFull = 0;
+	vUARTIntRxBufDataCnt -= n;
+	if(vUARTIntRxBufDataCnt == 0 )
+		vUARTIntStatus.UARTIntRxBufferEmpty = 1;
+	PIE1bits.RCIE = 1;
+	return n;
+}
+
 /*********************************************************************
  * Function:        	unsigned char UARTIntGetRxBufferDataSize(void)
  * PreCondition:    	UARTIntInit()function should have been called.
@@ -375,6 +430,7 @@ void UARTIntISR(void)
 				{ 
 					chTemp = RCREG;
 					vUARTIntStatus.UARTIntRxOverFlow = 1;
+					vUARTIntRxOverFlowCnt++;
 				}		 
 				else if(!vUARTIntStatus.UARTIntRxBufferFull)
 				{	
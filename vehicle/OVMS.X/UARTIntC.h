@@ -121,6 +121,7 @@ extern volatile unsigned char vUARTIntRxBuffer[RX_BUFFER_SIZE];
 extern volatile unsigned char vUARTIntRxBufDataCnt;
 extern volatile unsigned char vUARTIntRxBufWrPtr;
 extern volatile unsigned char vUARTIntRxBufRdPtr;
+extern volatile unsigned int vUARTIntRxOverFlowCnt;
 #endif
 
 //  functions offered by this module
@@ -128,6 +129,9 @@ extern volatile unsigned char vUARTIntRxBufRdPtr;
 // function returns a character from receive buffer
 unsigned char UARTIntGetChar(unsigned char*);
 
+// function reads a block of characters up to a stop character
+unsigned char UARTIntGetBlock(unsigned char*, unsigned char, unsigned char);
+
 // function returns the number of characters in receive buffer
 unsigned char UARTIntGetRxBufferDataSize(void);
 
@@ -28,6 +28,7 @@
 
 extern const rom unsigned char cb64[];
 
+void encodeblock(unsigned char in[3], unsigned char out[4], int len);
 char *base64encode(BYTE *inputData, WORD inputLen, BYTE *outputData);
 void base64encodesend(BYTE *inputData, WORD inputLen);
 int base64decode(BYTE *inputData, BYTE *outputData);
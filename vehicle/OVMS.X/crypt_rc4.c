@@ -88,3 +88,29 @@ void RC4_crypt(RC4_CTX1 *ctx1, RC4_CTX2 *ctx2, unsigned char *msg, int length)
   ctx1->x = x;
   ctx1->y = y;
   }
+
+/**
+ * Undo the last length steps of RC4_crypt, restoring the state it
+ * had before. This allows reuse of a primed state without a new setup.
+ */
+void RC4_rewind(RC4_CTX1 *ctx1, RC4_CTX2 *ctx2, int length)
+  {
+  int i;
+  unsigned char *m, x, y, a;
+
+  x = ctx1->x;
+  y = ctx1->y;
+  m = ctx2->m;
+
+  for (i = 0; i < length; i++)
+    {
+    a = m[y];
+    m[y] = m[x];
+    m[x] = a;
+    y -= a;
+    x--;
+    }
+
+  ctx1->x = x;
+  ctx1->y = y;
+  }
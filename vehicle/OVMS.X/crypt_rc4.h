@@ -47,5 +47,6 @@ typedef struct
 
 void RC4_setup(RC4_CTX1 *ctx1, RC4_CTX2 *ctx2, const unsigned char *key, int length);
 void RC4_crypt(RC4_CTX1 *ctx1, RC4_CTX2 *ctx2, unsigned char *msg, int length);
+void RC4_rewind(RC4_CTX1 *ctx1, RC4_CTX2 *ctx2, int length);
 
 #endif //#ifndef __CRYPT_RC4_H
\ No newline at end of file
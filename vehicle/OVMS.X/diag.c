@@ -128,21 +128,18 @@ void diag_ticker(void)
     }
 #endif //OVMS_CAR_TESLAROADSTER
 
-  if (net_notify & (NET_NOTIFY_NET_CHARGE|NET_NOTIFY_SMS_CHARGE))
+  if (net_notify_cancel(NET_NOTIFY_T_CHARGE))
     {
     net_puts_rom("\n# NOTIFY CHARGE ALERT\n");
-    net_notify &= ~(NET_NOTIFY_NET_CHARGE|NET_NOTIFY_SMS_CHARGE);
     }
 #ifndef OVMS_NO_VEHICLE_ALERTS
-  if (net_notify & (NET_NOTIFY_NET_TRUNK|NET_NOTIFY_SMS_TRUNK))
+  if (net_notify_cancel(NET_NOTIFY_T_TRUNK))
     {
     net_puts_rom("\n# NOTIFY TRUNK ALERT\n");
-    net_notify &= ~(NET_NOTIFY_NET_TRUNK|NET_NOTIFY_SMS_TRUNK);
     }
-  if (net_notify & (NET_NOTIFY_NET_ALARM|NET_NOTIFY_SMS_ALARM))
+  if (net_notify_cancel(NET_NOTIFY_T_ALARM))
     {
     net_puts_rom("\n# NOTIFY ALARM ALERT\n");
-    net_notify &= ~(NET_NOTIFY_NET_ALARM|NET_NOTIFY_SMS_ALARM);
     }
 #endif //OVMS_NO_VEHICLE_ALERTS
   }
@@ -168,7 +165,11 @@ void diag_handle_help(char *command, char *arguments)
   {
   net_puts_rom("\n");
   delay100(1);
+#ifdef OVMS_POLLER
+  net_puts_rom("# COMMANDS: HELP ? DIAG POLL RESET or M/S ...\n");
+#else
   net_puts_rom("# COMMANDS: HELP ? DIAG RESET or M/S ...\n");
+#endif
   net_puts_rom("# 'M' COMMANDS:\n# ");
   net_msgp_capabilities(0);
   net_puts_rom("# 'S' COMMANDS:");
@@ -239,6 +240,81 @@ void diag_handle_diag(char *command, char *arguments)
   net_puts_ram(net_scratchpad);
   #endif
 
+  #ifdef OVMS_POLLER
+  if (vehicle_poll_plist != NULL)
+    {
+    // Poll scheduling delay per state: avg/max seconds
+    s = stp_rom(net_scratchpad, "#  POLL:    ");
+    for (x=0; x<VEHICLE_POLL_NSTATES; x++)
+      {
+      s = stp_i(s, " ", (vehicle_poll_latecnt[x])
+              ? vehicle_poll_latesum[x] / vehicle_poll_latecnt[x] : 0);
+      s = stp_i(s, "/", vehicle_poll_latemax[x]);
+      }
+    s = stp_rom(s, " s late\n");
+    net_puts_ram(net_scratchpad);
+    s = stp_i(net_scratchpad, "#  ISOTP:    ", vehicle_poll_ml_errors);
+    s = stp_i(s, " seq err / ", vehicle_poll_ml_timeouts);
+    s = stp_rom(s, " timeouts\n");
+    net_puts_ram(net_scratchpad);
+    }
+  #endif
+
+  #ifdef OVMS_CANTXQUEUE
+  s = stp_i(net_scratchpad, "#  CANTXQ:   ", vehicle_txq_maxdepth);
+  s = stp_i(s, " max / ", vehicle_txq_dropped);
+  s = stp_i(s, " drop / ", vehicle_txq_errors);
+  s = stp_rom(s, " err\n");
+  net_puts_ram(net_scratchpad);
+  #endif
+
+  #ifdef OVMS_CANRXQUEUE
+  s = stp_i(net_scratchpad, "#  CANRXQ:   ", vehicle_rxq_maxdepth);
+  s = stp_i(s, " max / ", vehicle_rxq_dropped[0]);
+  s = stp_i(s, "+", vehicle_rxq_dropped[1]);
+  s = stp_i(s, " drop / ", vehicle_can_overflow[0]);
+  s = stp_i(s, "+", vehicle_can_overflow[1]);
+  s = stp_rom(s, " ovfl\n");
+  net_puts_ram(net_scratchpad);
+  #endif
+
+  #ifdef OVMS_CANSTATS
+  s = stp_i(net_scratchpad, "#  CANBUS:   ", vehicle_canstat_kbps);
+  s = stp_i(s, " kbps, ", vehicle_canstat_fps);
+  s = stp_i(s, "/", vehicle_canstat_fpsmax);
+  s = stp_i(s, " fps, load ", vehicle_canstat_loadavg);
+  s = stp_i(s, "/", vehicle_canstat_loadmax);
+  s = stp_i(s, "%, ovfl ", vehicle_can_overflow[0]);
+  s = stp_i(s, "+", vehicle_can_overflow[1]);
+  s = stp_rom(s, "\n");
+  net_puts_ram(net_scratchpad);
+  #endif
+
+  s = stp_i(net_scratchpad, "#  UARTTX:   ", net_tx_hiwater);
+  s = stp_i(s, " / ", TX_BUFFER_SIZE);
+  s = stp_ul(s, " max, blocked ", (net_tx_blocked * 32) / 625);
+  s = stp_rom(s, " ms\n");
+  net_puts_ram(net_scratchpad);
+
+  #ifdef OVMS_FASTBAUD
+  s = stp_ul(net_scratchpad, "#  Baud:     ", (net_baud_fast) ? NET_BAUD_FAST : 9600);
+  s = stp_rom(s, "\n");
+  net_puts_ram(net_scratchpad);
+  #endif
+
+  s = stp_ul(net_scratchpad, "#  CIPSEND:  ", net_msg_txcnt);
+  s = stp_ul(s, " / ", net_msg_txtotal);
+  s = stp_ul(s, " bytes, avg ", (net_msg_txcnt) ? net_msg_txtotal / net_msg_txcnt : 0);
+  s = stp_rom(s, "\n");
+  net_puts_ram(net_scratchpad);
+
+  #ifdef OVMS_CANCACHE
+  s = stp_ul(net_scratchpad, "#  CANCACHE: ", vehicle_cancache_hits);
+  s = stp_ul(s, " / ", vehicle_cancache_checks);
+  s = stp_rom(s, " unchanged\n");
+  net_puts_ram(net_scratchpad);
+  #endif
+
   s = stp_i(net_scratchpad, "#  Signal:   ", net_sq);
   s = stp_rom(s, "\n\n");
   net_puts_ram(net_scratchpad);
@@ -279,6 +355,74 @@ void diag_handle_diag(char *command, char *arguments)
   net_puts_rom("AT+CSQ\r");
   }
 
+#ifdef OVMS_CANSTATS
+void diag_handle_canstat(char *command, char *arguments)
+  {
+  vehicle_canstat_t e;
+  unsigned int done = 0;
+  char *s;
+
+  net_puts_rom("\n# CANSTAT\n");
+  s = stp_ul(net_scratchpad, "# RXB0/1: ", vehicle_canstat_getframes(0));
+  s = stp_ul(s, " / ", vehicle_canstat_getframes(1));
+  s = stp_i(s, " frames in ", vehicle_canstat_secs);
+  s = stp_rom(s, " s\n");
+  net_puts_ram(net_scratchpad);
+
+  // Top talkers: id: frames / bytes
+  while (vehicle_canstat_top(&done, &e))
+    {
+    s = stp_x(net_scratchpad, "# ", e.id);
+    s = stp_ul(s, ": ", e.frames);
+    s = stp_ul(s, " / ", e.bytes);
+    s = stp_rom(s, "\n");
+    net_puts_ram(net_scratchpad);
+    }
+
+  if (arguments && ((*arguments == 'R')||(*arguments == 'r')))
+    {
+    vehicle_canstat_reset();
+    net_puts_rom("# (reset)\n");
+    }
+  }
+#endif //OVMS_CANSTATS
+
+#ifdef OVMS_POLLER
+void diag_handle_poll(char *command, char *arguments)
+  {
+  unsigned char k;
+  rom vehicle_pid_t *p;
+  vehicle_pollstat_t *st;
+  char *s;
+
+  net_puts_rom("\n# POLL\n");
+  if (vehicle_poll_plist == NULL)
+    {
+    net_puts_rom("# (no poll list)\n");
+    return;
+    }
+
+  // Per entry: module / type / pid: requests / responses / timeouts,
+  //  response latency min/avg/max ms
+  for (k=0, p=vehicle_poll_plist;
+       (k<VEHICLE_POLL_MAXPIDS)&&(p->moduleid != 0); k++, p++)
+    {
+    st = &vehicle_poll_stats[k];
+    s = stp_x(net_scratchpad, "# ", p->moduleid);
+    s = stp_sx(s, " ", p->type);
+    s = stp_x(s, " ", p->pid);
+    s = stp_ul(s, ": ", st->req);
+    s = stp_ul(s, " / ", st->resp);
+    s = stp_i(s, " / ", st->timeouts);
+    s = stp_i(s, " tmo, ", st->latmin);
+    s = stp_i(s, "/", st->latavg);
+    s = stp_i(s, "/", st->latmax);
+    s = stp_rom(s, " ms\n");
+    net_puts_ram(net_scratchpad);
+    }
+  }
+#endif //OVMS_POLLER
+
 void diag_handle_csq(char *command, char *arguments)
   {
   net_sq = atoi(arguments);
@@ -336,6 +480,12 @@ rom char diag_cmdtable[][27] =
     "RESET",
     "DIAG",
     "+CSQ:",
+#ifdef OVMS_POLLER
+    "POLL",
+#endif //OVMS_POLLER
+#ifdef OVMS_CANSTATS
+    "CANSTAT",
+#endif //OVMS_CANSTATS
 #ifdef OVMS_CAR_TESLAROADSTER
     "CANTXSTART",
     "CANTXSTOP",
@@ -352,6 +502,12 @@ rom void (*diag_hfntable[])(char *command, char *arguments) =
   &diag_handle_reset,
   &diag_handle_diag,
   &diag_handle_csq
+#ifdef OVMS_POLLER
+  ,&diag_handle_poll
+#endif //OVMS_POLLER
+#ifdef OVMS_CANSTATS
+  ,&diag_handle_canstat
+#endif //OVMS_CANSTATS
 #ifdef OVMS_CAR_TESLAROADSTER
   ,&diag_handle_cantxstart,
   &diag_handle_cantxstop,
@@ -72,14 +72,36 @@ unsigned char net_socalert_msg = 0;         // SOC Alert (sms) 10min ticks remai
 #endif //#ifdef OVMS_SOCALERT
 
 #ifndef OVMS_NO_ERROR_NOTIFY
-unsigned int  net_notify_errorcode = 0;     // An error code to be notified
-unsigned long net_notify_errordata = 0;     // Ancilliary data
 unsigned int  net_notify_lasterrorcode = 0; // Last error code to be notified
 unsigned char net_notify_lastcount = 0;     // A counter used to clear error codes
 #endif //OVMS_NO_ERROR_NOTIFY
 
-unsigned int  net_notify = 0;               // Bitmap of notifications outstanding
+net_notify_entry net_notify_queue[NET_NOTIFY_QUEUE]; // Notifications outstanding
+unsigned int  net_notify_secs = 0;          // Seconds counter for notification timing
+unsigned int  net_notify_latcnt[NET_NOTIFY_PRIOS] = {0,0,0,0}; // Notifications sent by priority
+unsigned long net_notify_latsum[NET_NOTIFY_PRIOS] = {0,0,0,0}; // Sum of request to send times (s)
+unsigned int  net_notify_latmax[NET_NOTIFY_PRIOS] = {0,0,0,0}; // Max request to send time (s)
+unsigned char net_notify_dropped = 0;       // Requests lost on a full queue
+unsigned char net_notify_smsturn = 0;       // 1 = SMS lane goes first on next idle poll
+unsigned long net_tx_blocked = 0;           // Time spent waiting for TX buffer space (TMR0 ticks)
+unsigned char net_tx_hiwater = 0;           // Max TX buffer fill level
+unsigned char net_rx_hiwater = 0;           // Max RX buffer fill level
+unsigned char net_reconn_tcptries = 0;      // Tier 1 (TCP reconnect) attempts
+unsigned int  net_reconn_cnt[3] = {0,0,0};  // Recovery attempts by tier (TCP, GPRS, modem)
+unsigned long net_uart_bytes = 0;           // Modem UART bytes exchanged (TX+RX) since FIRSTRUN
+unsigned int  net_conn_secs = 0;            // Seconds since FIRSTRUN / connection loss (0 = logged in)
+unsigned long net_conn_ubase = 0;           // net_uart_bytes at FIRSTRUN / connection loss
+unsigned int  net_conn_tready = 0;          // Seconds FIRSTRUN / connection loss -> READY (0 = not yet)
+unsigned int  net_conn_tlogin = 0;          // Seconds FIRSTRUN / connection loss -> server login (0 = not yet)
+unsigned long net_conn_bytes = 0;           // UART bytes exchanged until the last server login
+#ifdef OVMS_FASTBAUD
+unsigned char net_baud_fast = 0;            // 1 = UART running at NET_BAUD_FAST
+unsigned char net_baud_failed = 0;          // 1 = fast rate verification failed (until HARDRESET / FIRSTRUN)
+#endif // OVMS_FASTBAUD
 unsigned char net_notify_suppresscount = 0; // To suppress STAT notifications (seconds)
+#ifdef OVMS_CANSTATS
+unsigned char net_canstats_due = 0;         // 1 = CAN statistics to be sent
+#endif // OVMS_CANSTATS
 
 #pragma udata NETBUF_SP
 char net_scratchpad[NET_BUF_MAX];           // A general-purpose scratchpad
@@ -129,6 +151,9 @@ rom char NET_HANGUP[] = "ATH\r";
 rom char NET_CREG_CIPSTATUS[] = "AT+CREG?;+CIPSTATUS;+CCLK?;+CSQ\r";
 rom char NET_CREG_STATUS[] = "AT+CREG?\r";
 rom char NET_IPR_SET[] = "AT+IPR=9600\r"; // sets fixed baud rate for the modem
+#ifdef OVMS_FASTBAUD
+rom char NET_IPR_FAST[] = "AT+IPR=57600\r"; // must match NET_BAUD_FAST
+#endif // OVMS_FASTBAUD
 
 ////////////////////////////////////////////////////////////////////////
 // The Interrupt Service Routine is standard PIC code
@@ -168,6 +193,33 @@ void net_reset_async(void)
   }
 
 
+#ifdef OVMS_FASTBAUD
+////////////////////////////////////////////////////////////////////////
+// net_baud_set()
+// Switch the UART to NET_BAUD_FAST (fast=1) or 9600 baud (fast=0)
+// after all queued characters have been sent.
+//
+void net_baud_set(unsigned char fast)
+  {
+  while (!vUARTIntStatus.UARTIntTxBufferEmpty) ; // wait for TX buffer
+  while (!TXSTAbits.TRMT) ; // wait for TX shift register
+  if (fast)
+    {
+    BAUDCONbits.BRG16 = 1;
+    SPBRGH = NET_SPBRG_FAST >> 8;
+    SPBRG = NET_SPBRG_FAST & 0xff;
+    }
+  else
+    {
+    BAUDCONbits.BRG16 = 0;
+    SPBRGH = 0;
+    SPBRG = SPBRG_VAL;
+    }
+  net_baud_fast = fast;
+  }
+#endif // OVMS_FASTBAUD
+
+
 ////////////////////////////////////////////////////////////////////////
 // net_assert_caller():
 // check for valid (non empty) caller, fallback to PARAM_REGPHONE
@@ -197,12 +249,16 @@ char *net_assert_caller(char *caller)
 //
 void net_poll(void)
   {
-  unsigned char x;
+  unsigned char x, k;
 
   CHECKPOINT(0x30)
 
+  if (vUARTIntRxBufDataCnt > net_rx_hiwater)
+    net_rx_hiwater = vUARTIntRxBufDataCnt;
+
   while(UARTIntGetChar(&x))
     {
+    net_uart_bytes++;
     
     if (net_buf_mode==NET_BUF_CRLF)
       { // CRLF (either normal or SMS second line) mode
@@ -329,17 +385,28 @@ void net_poll(void)
       CHECKPOINT(0x34)
       
       // Add char to buffer:
-      if (x != 0x0d) // Swallow CR
+      net_buf[net_buf_pos++] = x;
+      if (net_buf_pos == NET_BUF_MAX) net_buf_pos--;
+      net_buf_todo--;
+      
+      // Take the rest of the line from the RX buffer in one block:
+      if ((x != 0x0A) && (net_buf_todo > 0))
         {
-        net_buf[net_buf_pos++] = x;
-        if (net_buf_pos == NET_BUF_MAX) net_buf_pos--;
+        k = (NET_BUF_MAX-1) - net_buf_pos;
+        if (k > net_buf_todo) k = net_buf_todo;
+        k = UARTIntGetBlock((unsigned char *)net_buf+net_buf_pos, k, 0x0A);
+        net_buf_pos += k;
+        net_buf_todo -= k;
+        net_uart_bytes += k;
+        if (k > 0) x = net_buf[net_buf_pos-1];
         }
-      net_buf_todo--;
       
       // Newline = message protocol termination?
       if (x == 0x0A)
         {
         net_buf_pos--;
+        if ((net_buf_pos > 0) && (net_buf[net_buf_pos-1] == 0x0D))
+          net_buf_pos--; // Swallow CR
         net_buf[net_buf_pos] = 0; // mark end of string for string search functions.
         
         // Handle message:
@@ -366,6 +433,71 @@ void net_poll(void)
   }
 
 
+// Read TMR0 (51.2 us ticks, see main loop):
+unsigned int net_tx_tmr0(void)
+  {
+  unsigned int t;
+  t = TMR0L; // latches TMR0H
+  t += ((unsigned int) TMR0H) << 8;
+  return t;
+  }
+
+////////////////////////////////////////////////////////////////////////
+// net_tx_putc()
+// Transmit one character to the async port.
+// N.B. This blocks if the transmit buffer is full.
+//
+void net_tx_putc(unsigned char c)
+  {
+  unsigned int t;
+
+  if (vUARTIntStatus.UARTIntTxBufferFull)
+    {
+    t = net_tx_tmr0();
+    while (vUARTIntStatus.UARTIntTxBufferFull) ; // wait for TxBuffer
+    net_tx_blocked += (unsigned int)(net_tx_tmr0() - t);
+    }
+  while (UARTIntPutChar(c)==0) ;
+  net_uart_bytes++;
+  if (vUARTIntTxBufDataCnt > net_tx_hiwater)
+    net_tx_hiwater = vUARTIntTxBufDataCnt;
+  }
+
+#define UART_WAIT_PUTC(c) { net_tx_putc(c); }
+
+////////////////////////////////////////////////////////////////////////
+// net_tx_room()
+// Check if <len> characters can be queued without blocking.
+// Use this to defer output while the transmit buffer is busy.
+//
+BOOL net_tx_room(unsigned int len)
+  {
+  return (UARTIntGetTxBufferEmptySpace() >= len);
+  }
+
+////////////////////////////////////////////////////////////////////////
+// net_tx_puts_ram()
+// Non-blocking transmit: queue zero-terminated character data from RAM
+// completely or not at all. Writes to the UART only (no SMS wrapper or
+// DIAG mode handling, use net_puts_ram() for these).
+// Returns FALSE if the transmit buffer is too busy, retry later.
+//
+BOOL net_tx_puts_ram(const char *data)
+  {
+  unsigned int len = strlen(data);
+
+  if (!net_tx_room(len))
+    return FALSE;
+  // room checked, so no need to wait per character:
+  for (;*data;data++)
+    UARTIntPutChar(*data);
+  net_uart_bytes += len;
+  if (vUARTIntTxBufDataCnt > net_tx_hiwater)
+    net_tx_hiwater = vUARTIntTxBufDataCnt;
+  return TRUE;
+  }
+
+
 ////////////////////////////////////////////////////////////////////////
 // net_wait4modem()
 // 
@@ -378,11 +510,14 @@ void net_poll(void)
 void net_wait4modem()
   {
   UINT8 c, len;
+  unsigned int t;
   
   // wait for TX flush:
   if (!vUARTIntStatus.UARTIntTxBufferEmpty)
     {
+    t = net_tx_tmr0();
     while (!vUARTIntStatus.UARTIntTxBufferEmpty);
+    net_tx_blocked += (unsigned int)(net_tx_tmr0() - t);
     // add 25 ms processing time:
     delay5(5);
     }
@@ -444,13 +579,6 @@ BOOL net_wait4prompt()
 // N.B. This may block if the transmit buffer is full.
 //
 
-// Macro to wait for TxBuffer before call to PutChar():
-#define UART_WAIT_PUTC(c) \
-  { \
-  while (vUARTIntStatus.UARTIntTxBufferFull) ; \
-  while (UARTIntPutChar(c)==0) ; \
-  }
-
 void net_puts_rom(const rom char *data)
   {
   
@@ -558,9 +686,9 @@ void net_puts_ram(const char *data)
     }
 #endif // OVMS_DIAGMODULE
 
-  else
+  else if (!net_tx_puts_ram(data))
     {
-    // Send characters up to the null
+    // TX buffer too busy, send characters up to the null as space frees:
     for (;*data;data++)
       UART_WAIT_PUTC(*data)
     }
@@ -585,6 +713,176 @@ void net_putc_ram(const char data)
     }
   }
 
+// Priority and deadline (seconds) by notification type (NET_NOTIFY_T_*):
+rom unsigned char net_notify_prio[NET_NOTIFY_T_ERROR+1] =
+  { 2, 2, 1, 1, 0, 0, 1, 3, 0 };
+rom unsigned char net_notify_deadline[NET_NOTIFY_T_ERROR+1] =
+  { 60, 30, 10, 10, 0, 0, 10, 10, 0 };
+
+////////////////////////////////////////////////////////////////////////
+// net_notify_add()
+// Queue a notification of the type (NET_NOTIFY_T_* + lane flag),
+// or coalesce it into the queued entry of the same type (all errors
+// share one entry, the newest error code wins).
+// IP entries are only queued if enabled, and leave NET_NOTIFY_SMSRESERVE
+// entries to the SMS lane. While offline they wait for the next login.
+// If the queue (or the IP share) is full, the least important entry of
+// the lane(s) available is replaced, else the request is dropped.
+// May be called from high_isr (CAN handlers), the queue is updated
+// with high priority interrupts disabled.
+//
+void net_notify_add(unsigned char type, unsigned int errorcode, unsigned long errordata)
+  {
+  unsigned char k, t, prio, gie;
+  unsigned char ipcnt = 0;
+  signed char found = -1;
+  signed char slot = -1;
+  signed char victim = -1;
+
+  if (((type & NET_NOTIFY_LANE_SMS) == 0) && ((par_notifies & PAR_NOTIFY_IP) == 0))
+    return;
+
+  prio = net_notify_prio[type & NET_NOTIFY_TYPE];
+
+  gie = INTCONbits.GIEH;
+  INTCONbits.GIEH = 0;
+
+  for (k=0; k<NET_NOTIFY_QUEUE; k++)
+    {
+    t = net_notify_queue[k].type;
+    if (t == NET_NOTIFY_FREE)
+      {
+      if (slot < 0) slot = k;
+      continue;
+      }
+    if ((t & NET_NOTIFY_LANE_SMS) == 0)
+      ipcnt++;
+    if (t == type)
+      {
+      found = k; // coalesce
+      break;
+      }
+    if ((t & NET_NOTIFY_LANE_SMS) && ((type & NET_NOTIFY_LANE_SMS) == 0))
+      continue; // IP requests may not replace SMS entries
+    if (net_notify_prio[t & NET_NOTIFY_TYPE] > prio)
+      {
+      if ((victim < 0) || (net_notify_prio[t & NET_NOTIFY_TYPE] >
+                           net_notify_prio[net_notify_queue[victim].type & NET_NOTIFY_TYPE]))
+        victim = k;
+      }
+    }
+
+  if (found < 0)
+    {
+    if (((type & NET_NOTIFY_LANE_SMS) == 0) &&
+        (ipcnt >= (NET_NOTIFY_QUEUE - NET_NOTIFY_SMSRESERVE)))
+      slot = -1; // IP share used up
+
+    if (slot < 0)
+      {
+      net_notify_dropped++;
+      slot = victim;
+      }
+
+    if (slot >= 0)
+      {
+      net_notify_queue[slot].type = type;
+      net_notify_queue[slot].since = net_notify_secs;
+      found = slot;
+      }
+    }
+
+  if (found >= 0)
+    {
+    net_notify_queue[found].errorcode = errorcode;
+    net_notify_queue[found].errordata = errordata;
+    }
+
+  if (gie) INTCONbits.GIEH = 1;
+  }
+
+////////////////////////////////////////////////////////////////////////
+// net_notify_next()
+// Find the next entry to send in a lane (0 = IP, NET_NOTIFY_LANE_SMS):
+// the highest priority entry, entries beyond their deadline count as
+// priority 0. The oldest entry goes first on equal priority.
+// Returns the queue index, or -1 if the lane is empty.
+//
+signed char net_notify_next(unsigned char lane)
+  {
+  unsigned char k, t, prio;
+  unsigned char best = 0xff;
+  signed char next = -1;
+
+  for (k=0; k<NET_NOTIFY_QUEUE; k++)
+    {
+    t = net_notify_queue[k].type;
+    if ((t == NET_NOTIFY_FREE) || ((t & NET_NOTIFY_LANE_SMS) != lane))
+      continue;
+    t &= NET_NOTIFY_TYPE;
+    prio = net_notify_prio[t];
+    if ((net_notify_secs - net_notify_queue[k].since) >= net_notify_deadline[t])
+      prio = 0;
+    if ((prio < best) ||
+        ((prio == best) && ((net_notify_secs - net_notify_queue[k].since) >
+                            (net_notify_secs - net_notify_queue[next].since))))
+      {
+      best = prio;
+      next = k;
+      }
+    }
+
+  return next;
+  }
+
+////////////////////////////////////////////////////////////////////////
+// net_notify_done()
+// Remove a sent entry from the queue and record its latency
+// (read the entry before, net_notify_add() may reuse it from high_isr)
+//
+void net_notify_done(unsigned char k)
+  {
+  unsigned char prio, gie;
+  unsigned int lat;
+
+  gie = INTCONbits.GIEH;
+  INTCONbits.GIEH = 0;
+  prio = net_notify_prio[net_notify_queue[k].type & NET_NOTIFY_TYPE];
+  lat = net_notify_secs - net_notify_queue[k].since;
+  net_notify_latcnt[prio]++;
+  net_notify_latsum[prio] += lat;
+  if (lat > net_notify_latmax[prio])
+    net_notify_latmax[prio] = lat;
+  net_notify_queue[k].type = NET_NOTIFY_FREE;
+  if (gie) INTCONbits.GIEH = 1;
+  }
+
+////////////////////////////////////////////////////////////////////////
+// net_notify_cancel()
+// Remove all queued entries of a type (NET_NOTIFY_T_*) in both lanes
+// Returns TRUE if an entry has been removed.
+//
+BOOL net_notify_cancel(unsigned char type)
+  {
+  unsigned char k, gie;
+  BOOL found = FALSE;
+
+  gie = INTCONbits.GIEH;
+  INTCONbits.GIEH = 0;
+  for (k=0; k<NET_NOTIFY_QUEUE; k++)
+    {
+    if ((net_notify_queue[k].type != NET_NOTIFY_FREE) &&
+        ((net_notify_queue[k].type & NET_NOTIFY_TYPE) == type))
+      {
+      net_notify_queue[k].type = NET_NOTIFY_FREE;
+      found = TRUE;
+      }
+    }
+  if (gie) INTCONbits.GIEH = 1;
+
+  return found;
+  }
+
 #ifndef OVMS_NO_ERROR_NOTIFY
 ////////////////////////////////////////////////////////////////////////
 // net_req_notification_error()
@@ -597,9 +895,8 @@ void net_req_notification_error(unsigned int errorcode, unsigned long errordata)
     if ((errorcode != net_notify_lasterrorcode)&&
         ((sys_features[FEATURE_CARBITS]&FEATURE_CB_SVALERTS)==0))
       {
-      // This is a new error, so set it and time it out after 60 seconds
-      net_notify_errorcode = errorcode;
-      net_notify_errordata = errordata;
+      // This is a new error, so queue it and time it out after 60 seconds
+      net_notify_add(NET_NOTIFY_T_ERROR, errorcode, errordata);
       net_notify_lasterrorcode = errorcode;
       net_notify_lastcount = 60;
       }
@@ -612,8 +909,7 @@ void net_req_notification_error(unsigned int errorcode, unsigned long errordata)
   else
     {
     // Clear the error
-    net_notify_errorcode = 0;
-    net_notify_errordata = 0;
+    net_notify_cancel(NET_NOTIFY_T_ERROR);
     net_notify_lasterrorcode = 0;
     net_notify_lastcount = 0;
     }
@@ -627,15 +923,16 @@ void net_req_notification_error(unsigned int errorcode, unsigned long errordata)
 //
 void net_req_notification(unsigned int notify)
   {
-  char *p;
-  p = par_get(PARAM_NOTIFIES);
-  if (strstrrampgm(p,(char const rom far*)"SMS") != NULL)
-    {
-    net_notify |= (notify<<8); // SMS notification flags are top 8 bits
-    }
-  if (strstrrampgm(p,(char const rom far*)"IP") != NULL)
+  unsigned char t;
+  unsigned int m;
+
+  for (t=0, m=1; t<8; t++, m<<=1)
     {
-    net_notify |= notify;      // NET notification flags are bottom 8 bits
+    if ((notify & m) == 0)
+      continue;
+    if ((par_notifies & PAR_NOTIFY_SMS) && (NET_NOTIFY_SMSTYPES & m))
+      net_notify_add(t | NET_NOTIFY_LANE_SMS, 0, 0);
+    net_notify_add(t, 0, 0);
     }
   }
 
@@ -715,6 +1012,14 @@ void net_state_enter(unsigned char newstate)
       led_start();
       net_timeout_goto = NET_STATE_START;
       net_timeout_ticks = 10; // Give everything time to start slowly
+      net_uart_bytes = 0;
+      net_conn_secs = 0;
+      net_conn_tready = 0;
+      net_conn_tlogin = 0;
+#ifdef OVMS_FASTBAUD
+      net_baud_set(0); // DIAG terminal & modem autobaud
+      net_baud_failed = 0; // retry the fast rate
+#endif // OVMS_FASTBAUD
       break;
       
 #ifdef OVMS_DIAGMODULE
@@ -732,6 +1037,7 @@ void net_state_enter(unsigned char newstate)
       break;
     case NET_STATE_SOFTRESET:
       net_timeout_goto = 0;
+      net_reconn_cnt[2]++;
       break;
       
     case NET_STATE_HARDRESET:
@@ -746,6 +1052,9 @@ void net_state_enter(unsigned char newstate)
       net_state_vchar = 0;
       net_msg_disconnected();
       net_cops_tries = 0; // Reset the COPS counter
+#ifdef OVMS_FASTBAUD
+      net_baud_failed = 0; // retry the fast rate
+#endif // OVMS_FASTBAUD
       break;
       
     case NET_STATE_HARDSTOP:
@@ -792,6 +1101,25 @@ void net_state_enter(unsigned char newstate)
       net_puts_rom(NET_INIT1);
 #endif
       break;
+#ifdef OVMS_FASTBAUD
+    case NET_STATE_DOBAUD:
+      // Request the new rate, the modem answers OK at the old rate:
+      net_timeout_goto = NET_STATE_DOBAUDFAIL;
+      net_timeout_ticks = 5;
+      net_state_vchar = 0;
+      net_puts_rom(NET_IPR_FAST);
+      break;
+    case NET_STATE_DOBAUDFAIL:
+      // The modem may or may not have switched, reset it to 9600:
+      if (!net_baud_fast)
+        net_baud_set(1);
+      delay100(1);
+      net_puts_rom(NET_IPR_SET);
+      net_baud_set(0);
+      net_baud_failed = 1;
+      net_state_enter(NET_STATE_START);
+      break;
+#endif // OVMS_FASTBAUD
     case NET_STATE_DOINIT2:
       led_set(OVMS_LED_GRN,NET_LED_INITSIM2);
       led_set(OVMS_LED_RED,OVMS_LED_OFF);
@@ -811,6 +1139,8 @@ void net_state_enter(unsigned char newstate)
     
     case NET_STATE_NETINITP:
       led_set(OVMS_LED_GRN,NET_LED_NETINIT);
+      net_reconn_cnt[1]++;
+      net_reconn_tcptries = 0;
       // Check retry count:
       if (--net_state_vint > 0)
         {
@@ -826,27 +1156,27 @@ void net_state_enter(unsigned char newstate)
       break;
     
     case NET_STATE_NETINITCP:
+      // Recovery tier 1: TCP reconnect
+      if (++net_reconn_tcptries > NET_RECONN_TCP_TRIES)
+        {
+        // escalate to tier 2: GPRS re-attach
+        net_state_enter(NET_STATE_NETINITP);
+        break;
+        }
+      net_reconn_cnt[0]++;
       led_set(OVMS_LED_GRN,NET_LED_NETINIT);
       net_puts_rom("AT+CIPCLOSE\r");
       led_set(OVMS_LED_RED,NET_LED_ERRCONNFAIL);
-      // Check retry count:
-      if (--net_state_vint > 0)
-        {
-        net_timeout_goto = NET_STATE_DONETINITC;
-        }
-      else
-        {
-        net_timeout_goto = NET_STATE_SOFTRESET;
-        }
-      net_timeout_ticks = (NET_GPRS_RETRIES-net_state_vint)*5;
+      net_timeout_goto = NET_STATE_DONETINITC;
+      net_timeout_ticks = net_reconn_tcptries*2;
       break;
     case NET_STATE_DONETINITC:
       led_set(OVMS_LED_GRN,NET_LED_NETINIT);
       led_set(OVMS_LED_RED,OVMS_LED_OFF);
       net_watchdog=0; // Disable watchdog, as we have connectivity
       net_reg = 0x05; // Assume connectivity (as COPS worked)
-      net_timeout_goto = NET_STATE_SOFTRESET;
-      net_timeout_ticks = 60;
+      net_timeout_goto = NET_STATE_NETINITCP; // retry / escalate
+      net_timeout_ticks = NET_RECONN_TCP_TIMEOUT;
       net_state_vchar = NETINIT_CLPORT;
       net_msg_disconnected();
       delay100(2);
@@ -863,7 +1193,7 @@ void net_state_enter(unsigned char newstate)
       if ((p[0] != '\0') && inputs_gsmgprs()) // APN defined AND switch is set to GPRS mode
         {
         net_timeout_goto = NET_STATE_SOFTRESET;
-        net_timeout_ticks = 60;
+        net_timeout_ticks = NET_RECONN_GPRS_TIMEOUT;
         net_state_vchar = NETINIT_START;
         net_msg_disconnected();
         delay100(2);
@@ -876,6 +1206,7 @@ void net_state_enter(unsigned char newstate)
     case NET_STATE_READY:
       led_set(OVMS_LED_GRN,NET_LED_READY);
       led_set(OVMS_LED_RED,OVMS_LED_OFF);
+      net_conn_tready = net_conn_secs; // READY is only entered during setup
       net_msg_sendpending = 0;
       net_timeout_goto = 0;
       net_state_vchar = 0;
@@ -966,6 +1297,7 @@ void net_state_activity()
     CHECKPOINT(0x35)
     // Getting GPRS data from the server means our connection was good
     net_state_vint = NET_GPRS_RETRIES; // Count-down for DONETINIT attempts
+    net_reconn_tcptries = 0;
     return;
     }
 
@@ -995,9 +1327,40 @@ void net_state_activity()
         {
         // OK response from the modem
         led_set(OVMS_LED_RED,OVMS_LED_OFF);
+#ifdef OVMS_FASTBAUD
+        if ((!net_baud_fast) && (!net_baud_failed))
+          {
+          net_state_enter(NET_STATE_DOBAUD);
+          break;
+          }
+#endif // OVMS_FASTBAUD
         net_state_enter(NET_STATE_DOINIT);
         }
       break;
+#ifdef OVMS_FASTBAUD
+    case NET_STATE_DOBAUD:
+      if ((net_buf_pos >= 2)&&(net_buf[0] == 'O')&&(net_buf[1] == 'K'))
+        {
+        if (net_state_vchar == 0)
+          {
+          // Modem has switched, follow and verify:
+          net_baud_set(1);
+          delay100(1);
+          net_state_vchar = 1;
+          net_puts_rom("AT\r");
+          }
+        else
+          {
+          // Verified
+          net_state_enter(NET_STATE_DOINIT);
+          }
+        }
+      else if ((net_buf_pos >= 2)&&(net_buf[0] == 'E')&&(net_buf[1] == 'R'))
+        {
+        net_state_enter(NET_STATE_DOBAUDFAIL);
+        }
+      break;
+#endif // OVMS_FASTBAUD
     case NET_STATE_DOINIT:
       if ((net_buf_pos >= 4)&&(net_buf[0]=='+')&&(net_buf[1]=='C')&&(net_buf[2]=='S')&&(net_buf[3]=='M'))
         {
@@ -1050,7 +1413,11 @@ void net_state_activity()
         }
       break;
     case NET_STATE_DOINIT3:
-      if ((net_buf_pos >= 6)&&(net_buf[0] == '+')&&(net_buf[1] == 'I')&&(net_buf[2] == 'P')&&(net_buf[3] == 'R')&&(net_buf[6] != '9'))
+      if ((net_buf_pos >= 6)&&(net_buf[0] == '+')&&(net_buf[1] == 'I')&&(net_buf[2] == 'P')&&(net_buf[3] == 'R')&&(net_buf[6] != '9')
+#ifdef OVMS_FASTBAUD
+          &&(!net_baud_fast) // rate has been set by NET_STATE_DOBAUD
+#endif // OVMS_FASTBAUD
+          )
         {
         // +IPR != 9600
         // SET IPR (baudrate)
@@ -1503,76 +1870,70 @@ void net_state_activity()
 
 
 ////////////////////////////////////////////////////////////////////////
-// net_idlepoll()
-// 
-// This function is called from the main loop after each net_poll().
-// As net_poll() frees the net_msg_sendpending semaphore, this is
-// the place to send queued notifications without interfering with
-// the per second tickers.
+// net_idlepoll_ip()
 //
-void net_idlepoll(void)
+// Send the most important pending IP notification.
+// Called repeatedly by net_idlepoll() to fill one CIPSEND transaction.
+// Returns FALSE if nothing has been sent.
+//
+BOOL net_idlepoll_ip(void)
   {
   char stat;
   char cmd[5];
-
-#ifdef OVMS_DIAGMODULE
-  if ((net_state == NET_STATE_DIAGMODE))
-    ; // disable connection check
-  else
-#endif // OVMS_DIAGMODULE
-    // Connection ready & available?
-    if ((net_state!=NET_STATE_READY) || ((net_reg!=0x01)&&(net_reg!=0x05)))
-      return;
-  
-  if (!MODEM_READY())
-    return;
-
-  
-  /*************************************************************
-   * PROCESS BUFFERED COMMAND
-   */
-
-  if ((net_msg_cmd_code!=0) && (net_msg_serverok==1))
+  signed char k;
+  unsigned char i, type;
+  unsigned int errorcode;
+  unsigned long errordata;
+
+  // Take the entry, high_isr may add notifications:
+  INTCONbits.GIEH = 0;
+  k = net_notify_next(0);
+  if (k >= 0)
     {
-    net_msg_cmd_do();
-    return;
+    type = net_notify_queue[k].type;
+    errorcode = net_notify_queue[k].errorcode;
+    errordata = net_notify_queue[k].errordata;
+    if ((type != NET_NOTIFY_T_UPDATE) || (!net_msg_txopen))
+      net_notify_done(k);
     }
+  INTCONbits.GIEH = 1;
 
-  
-  /*************************************************************
-   * SEND IP NOTIFICATIONS
-   */
-
-#ifndef OVMS_NO_ERROR_NOTIFY
-  if ((net_notify_errorcode>0) && (net_msg_serverok==1))
+  if (k < 0)
     {
-    if (net_notify_errorcode > 0)
+#ifdef OVMS_LOGGINGMODULE
+    if (logging_haspending() > 0)
       {
-      net_msg_erroralert(net_notify_errorcode, net_notify_errordata);
+      net_msg_start();
+      logging_sendpending();
+      net_msg_send();
+      return TRUE;
       }
-    net_notify_errorcode = 0;
-    net_notify_errordata = 0;
-    return;
+#endif // #ifdef OVMS_LOGGINGMODULE
+    return FALSE;
     }
-#endif //OVMS_NO_ERROR_NOTIFY
 
-  if (((net_notify & NET_NOTIFY_NETPART)>0)
-          && (net_msg_serverok==1))
+  if ((type == NET_NOTIFY_T_UPDATE) && (net_msg_txopen))
+    return FALSE; // send in a transaction of its own
+
+  switch (type)
     {
+#ifndef OVMS_NO_ERROR_NOTIFY
+    case NET_NOTIFY_T_ERROR:
+      net_msg_erroralert(errorcode, errordata);
+      break;
+#endif //OVMS_NO_ERROR_NOTIFY
 
 #ifndef OVMS_NO_VEHICLE_ALERTS
-    if ((net_notify & NET_NOTIFY_NET_ALARM)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_ALARM); // Clear notification flag
+    case NET_NOTIFY_T_ALARM:
       net_msg_alert(ALERT_ALARM);
-      return;
-      }
-    else
+      break;
+
+    case NET_NOTIFY_T_TRUNK:
+      net_msg_alert(ALERT_TRUNK);
+      break;
 #endif //OVMS_NO_VEHICLE_ALERTS
-      
-    if ((net_notify & NET_NOTIFY_NET_CHARGE)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_CHARGE); // Clear notification flag
+
+    case NET_NOTIFY_T_CHARGE:
       if (net_notify_suppresscount==0)
         {
         // execute CHARGE ALERT command:
@@ -1581,36 +1942,26 @@ void net_idlepoll(void)
         net_msg_cmd_msg[0] = 0;
         net_msg_cmd_do();
         }
-      return;
-      }
-    
-    else if ((net_notify & NET_NOTIFY_NET_12VLOW)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_12VLOW); // Clear notification flag
+      break;
+
+    case NET_NOTIFY_T_12VLOW:
       if (net_fnbits & NET_FN_12VMONITOR) net_msg_alert(ALERT_12VLOW);
-      return;
-      }
-    
-#ifndef OVMS_NO_VEHICLE_ALERTS
-    else if ((net_notify & NET_NOTIFY_NET_TRUNK)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_TRUNK); // Clear notification flag
-      net_msg_alert(ALERT_TRUNK);
-      return;
-      }
-#endif //OVMS_NO_VEHICLE_ALERTS
-    
-    else if ((net_notify & NET_NOTIFY_NET_CARON)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_CARON); // Clear notification flag
+      break;
+
+    case NET_NOTIFY_T_CARON:
       net_msg_alert(ALERT_CARON);
-      return;
-      }
-    
-    else if ((net_notify & NET_NOTIFY_NET_UPDATE)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_UPDATE | NET_NOTIFY_NET_STAT |
-              NET_NOTIFY_NET_STREAM); // Clear all covered notifications
+      break;
+
+    case NET_NOTIFY_T_UPDATE:
+      // Clear all covered notifications:
+      INTCONbits.GIEH = 0;
+      for (i=0; i<NET_NOTIFY_QUEUE; i++)
+        {
+        if ((net_notify_queue[i].type == NET_NOTIFY_T_STAT) ||
+            (net_notify_queue[i].type == NET_NOTIFY_T_STREAM))
+          net_notify_done(i);
+        }
+      INTCONbits.GIEH = 1;
       stat = 2;
       stat = net_msgp_stat(stat);
       stat = net_msgp_environment(stat);
@@ -1624,84 +1975,148 @@ void net_idlepoll(void)
       stat = net_msgp_capabilities(stat);
       if (stat != 2)
         net_msg_send();
-      return;
-      }
-    
-    else if ((net_notify & NET_NOTIFY_NET_STAT)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_STAT); // Clear notification flag
+      break;
+
+    case NET_NOTIFY_T_STAT:
       stat = 2;
       stat = net_msgp_environment(stat);
       stat = net_msgp_stat(stat);
       if (stat != 2)
         net_msg_send();
-      return;
-      }
-    
-    else if ((net_notify & NET_NOTIFY_NET_STREAM)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_NET_STREAM); // Clear notification flag
+      break;
+
+    case NET_NOTIFY_T_STREAM:
       if (net_msgp_gps(2) != 2)
         net_msg_send();
-      return;
-      }
-    
-    } // if NET_NOTIFY_NETPART
+      break;
+    }
 
-  
-  /*************************************************************
-   * SEND SMS NOTIFICATIONS
-   */
-  if ((net_notify & NET_NOTIFY_SMSPART)>0)
+  return TRUE;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// net_idlepoll_sms()
+//
+// Send the most important pending SMS notification.
+// Returns FALSE if nothing has been sent.
+//
+BOOL net_idlepoll_sms(void)
+  {
+  char cmd[5];
+  signed char k;
+  unsigned char type;
+
+  // Take the entry, high_isr may add notifications:
+  INTCONbits.GIEH = 0;
+  k = net_notify_next(NET_NOTIFY_LANE_SMS);
+  if (k >= 0)
+    {
+    type = net_notify_queue[k].type & NET_NOTIFY_TYPE;
+    net_notify_done(k);
+    }
+  INTCONbits.GIEH = 1;
+
+  if (k < 0)
+    return FALSE;
+
+  net_assert_caller(NULL); // set net_caller to PARAM_REGPHONE
+
+  switch (type)
     {
-    net_assert_caller(NULL); // set net_caller to PARAM_REGPHONE
-    
 #ifndef OVMS_NO_VEHICLE_ALERTS
-    if ((net_notify & NET_NOTIFY_SMS_ALARM)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_SMS_ALARM); // Clear notification flag
+    case NET_NOTIFY_T_ALARM:
       net_sms_alert(net_caller, ALERT_ALARM);
-      return;
-      }
-    else
+      break;
+
+    case NET_NOTIFY_T_TRUNK:
+      net_sms_alert(net_caller, ALERT_TRUNK);
+      break;
 #endif //OVMS_NO_VEHICLE_ALERTS
-    
-    if ((net_notify & NET_NOTIFY_SMS_CHARGE)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_SMS_CHARGE); // Clear notification flag
+
+    case NET_NOTIFY_T_CHARGE:
       if (net_notify_suppresscount==0)
         {
-          stp_rom(cmd, "STAT");
-          net_sms_in(net_caller, cmd);
+        stp_rom(cmd, "STAT");
+        net_sms_in(net_caller, cmd);
         }
-      return;
-      }
-    
-    else if ((net_notify & NET_NOTIFY_SMS_12VLOW)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_SMS_12VLOW); // Clear notification flag
+      break;
+
+    case NET_NOTIFY_T_12VLOW:
       if (net_fnbits & NET_FN_12VMONITOR) net_sms_alert(net_caller, ALERT_12VLOW);
+      break;
+
+    case NET_NOTIFY_T_CARON:
+      net_sms_alert(net_caller, ALERT_CARON);
+      break;
+    }
+
+  return TRUE;
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// net_idlepoll()
+// 
+// This function is called from the main loop after each net_poll().
+// As net_poll() frees the net_msg_sendpending semaphore, this is
+// the place to send queued notifications without interfering with
+// the per second tickers.
+//
+void net_idlepoll(void)
+  {
+  unsigned char k;
+
+#ifdef OVMS_DIAGMODULE
+  if ((net_state == NET_STATE_DIAGMODE))
+    ; // disable connection check
+  else
+#endif // OVMS_DIAGMODULE
+    // Connection ready & available?
+    if ((net_state!=NET_STATE_READY) || ((net_reg!=0x01)&&(net_reg!=0x05)))
       return;
-      }
+  
+  if (!MODEM_READY())
+    return;
 
-#ifndef OVMS_NO_VEHICLE_ALERTS
-    else if ((net_notify & NET_NOTIFY_SMS_TRUNK)>0)
-      {
-      net_notify &= ~(NET_NOTIFY_SMS_TRUNK); // Clear notification flag
-      net_sms_alert(net_caller, ALERT_TRUNK);
+  
+  /*************************************************************
+   * PROCESS BUFFERED COMMAND
+   */
+
+  if ((net_msg_cmd_code!=0) && (net_msg_serverok==1))
+    {
+    net_msg_cmd_do();
+    return;
+    }
+
+  
+  /*************************************************************
+   * SEND NOTIFICATIONS
+   * The IP and SMS lanes take turns if both have notifications
+   * pending. Pending IP notifications are collected into one CIPSEND.
+   */
+
+  if (net_notify_smsturn)
+    {
+    net_notify_smsturn = 0;
+    if (net_idlepoll_sms())
       return;
-      }
-#endif //OVMS_NO_VEHICLE_ALERTS
+    }
 
-    else if ((net_notify & NET_NOTIFY_SMS_CARON)>0)
+  if (net_msg_serverok==1)
+    {
+    net_msg_batch_begin();
+    for (k=0; net_msg_batch_room(1) && net_idlepoll_ip(); k++) ;
+    net_msg_batch_end();
+    if (k > 0)
       {
-      net_notify &= ~(NET_NOTIFY_SMS_CARON); // Clear notification flag
-      net_sms_alert(net_caller, ALERT_CARON);
+      net_notify_smsturn = 1;
       return;
       }
+    }
 
-    } // if NET_NOTIFY_SMSPART
-
+  net_idlepoll_sms();
   }
 
 
@@ -1715,6 +2130,8 @@ void net_state_ticker1(void)
   {
   CHECKPOINT(0x38)
 
+  net_notify_secs++;
+
 #ifndef OVMS_NO_ERROR_NOTIFY
   // Time out error codes
   if (net_notify_lastcount>0)
@@ -1727,6 +2144,21 @@ void net_state_ticker1(void)
     }
 #endif //OVMS_NO_ERROR_NOTIFY
 
+  // Connection setup timing, from FIRSTRUN or connection loss to login:
+  if (!net_msg_serverok)
+    {
+    if (net_conn_secs == 0)
+      net_conn_ubase = net_uart_bytes;
+    if (net_conn_secs < 0xffff)
+      net_conn_secs++;
+    }
+  else if (net_conn_secs > 0)
+    {
+    net_conn_tlogin = net_conn_secs;
+    net_conn_bytes = net_uart_bytes - net_conn_ubase;
+    net_conn_secs = 0;
+    }
+
   switch (net_state)
     {
     case NET_STATE_START:
@@ -1741,6 +2173,11 @@ void net_state_ticker1(void)
         // We are about to timeout, so let's set the error code...
         led_set(OVMS_LED_RED,NET_LED_ERRMODEM);
         }
+#ifdef OVMS_FASTBAUD
+      // The modem may still run at the fast rate (also if the fallback
+      // failed), probe both:
+      net_baud_set(net_timeout_ticks & 1);
+#endif // OVMS_FASTBAUD
 #ifdef OVMS_INTERNALGPS
       // Using internal SIMx08 GPS:
       if ((net_fnbits & NET_FN_INTERNALGPS) != 0)
@@ -1843,6 +2280,15 @@ void net_state_ticker1(void)
           }
 #endif
 
+#ifdef OVMS_CANSTATS
+      // Send CAN traffic statistics, retry each second until modem is ready:
+      if ((net_canstats_due) && (net_msg_serverok) && MODEM_READY())
+        {
+        net_msg_canstats();
+        net_canstats_due = 0;
+        }
+#endif // OVMS_CANSTATS
+
       // ...case NET_STATE_READY + registered...
       if ((net_reg == 0x01)||(net_reg == 0x05))
         {
@@ -2006,23 +2452,8 @@ void net_state_ticker60(void)
   switch (net_state)
     {
     case NET_STATE_READY:
-#ifdef OVMS_LOGGINGMODULE
-      if ((net_msg_serverok)&&(logging_haspending() > 0))
-        {
-        if (!MODEM_READY())
-          {
-          net_granular_tick -= 4; // Try again in 4 seconds...
-          }
-        else
-          {
-          net_msg_start();
-          logging_sendpending();
-          net_msg_send();
-          return;
-          }
-        }
-#endif // #ifdef OVMS_LOGGINGMODULE
-      
+      // Note: pending log records are sent by net_idlepoll()
+
       // Send standard update
       // once per minute while Apps are connected
       if (net_apps_connected>0)
@@ -2129,6 +2560,11 @@ void net_state_ticker3600(void)
       // once per hour if no Apps are connected and car is not busy
       if ((net_msg_serverok)&&(net_apps_connected==0)&&(!carbusy))
         net_req_notification(NET_NOTIFY_UPDATE);
+
+#ifdef OVMS_CANSTATS
+      // Send CAN traffic statistics (by ticker1 when the modem is ready):
+      net_canstats_due = 1;
+#endif // OVMS_CANSTATS
       
       break;
     }
@@ -2198,8 +2634,13 @@ void net_ticker10th(void)
 //
 void net_initialise(void)
   {
+  unsigned char k;
+
   UARTIntInit();
 
+  for (k=0; k<NET_NOTIFY_QUEUE; k++)
+    net_notify_queue[k].type = NET_NOTIFY_FREE;
+
   net_reg = 0;
   net_state_enter(NET_STATE_FIRSTRUN);
   }
@@ -41,6 +41,14 @@
 #define NET_BUF_TIMEOUT    10  // IP/SMS data RX timeout (modem lost)
 #define NET_IPACK_TIMEOUT  60  // async IP send ACK timeout (modem buffer / link problem)
 
+// Link recovery tiers:
+//  1. TCP reconnect (CIPCLOSE + CIPSTART), NET_RECONN_TCP_TRIES attempts
+//  2. GPRS re-attach (CIPSHUT + APN setup + CIPSTART), NET_GPRS_RETRIES attempts
+//  3. Full modem re-initialisation (SOFTRESET)
+#define NET_RECONN_TCP_TRIES    3   // Tier 1 attempts before escalating to tier 2
+#define NET_RECONN_TCP_TIMEOUT  30  // Tier 1 timeout per attempt
+#define NET_RECONN_GPRS_TIMEOUT 60  // Tier 2 timeout per attempt (-> tier 3)
+
 // NET_BUF_MODES
 #define NET_BUF_IPD          0xfd  // net_buf is waiting on IPD data
 #define NET_BUF_SMS          0xfe  // net_buf is waiting for 2nd line of SMS
@@ -57,6 +65,8 @@
 #define NET_STATE_DOINIT     0x10  // Initialise the GSM network - SIM card check
 #define NET_STATE_DOINIT2    0x11  // Initialise the GSM network - SIM PIN check
 #define NET_STATE_DOINIT3    0x12  // Initialise the GSM network - Full Init
+#define NET_STATE_DOBAUD     0x13  // Switch modem to fast baud rate
+#define NET_STATE_DOBAUDFAIL 0x14  // Fast baud rate failed, fall back to 9600
 #define NET_STATE_READY      0x20  // READY and handling calls
 #define NET_STATE_COPS       0x21  // GSM COPS carrier selection
 #define NET_STATE_COPSSETTLE 0x22  // GSM COPS wait for settle after lock
@@ -136,42 +146,83 @@ extern unsigned char net_fnbits;               // Net functionality bits
 #define BATT_12V_CALMDOWN_TIME 15              // calm down time in minutes after charge end
 
 // The NET/SMS notification system
-// We have a bitmap net_notify with bits set to request a particular notification
-// type, and cleared when the notification is issued.
+// We have a small queue net_notify_queue of typed notification entries, added
+// by net_req_notification() and removed when the notification is issued.
+// SMS and IP notifications are separate entries (lanes) and are sent
+// independently. A repeated request for a queued entry is coalesced into it,
+// keeping the time of the first request and the newest payload (all error
+// alerts share one entry). IP entries requested while offline are sent after
+// the next login. They may not use the last NET_NOTIFY_SMSRESERVE entries, so
+// a backlog of IP notifications cannot push out SMS alerts.
+// Requests may come from high_isr (CAN handlers), so the main loop takes and
+// removes entries with high priority interrupts disabled.
+// Entries are sent by priority, unless they are waiting beyond their deadline,
+// which makes them as urgent as an alert (so low priority notifications cannot
+// starve). The time from request to send is recorded per priority.
 // We also have a countdown timer net_notify_suppresscount which, if >0, signifies
 // that the charge event notification should not be sent. This is used because
 // we want to suppress notification of charge events in some circumstances
 // (such as if the user explicitely requests a charge to be stopped).
-// The idea is that requesters set these bits, and notifiers clear them.
-extern unsigned int  net_notify_errorcode;     // An error code to be notified
-extern unsigned long net_notify_errordata;     // Ancilliary data
+#define NET_NOTIFY_QUEUE      8        // Queue size (entries)
+#define NET_NOTIFY_PRIOS      4        // Priorities (0 = alerts .. 3 = streaming)
+#define NET_NOTIFY_SMSRESERVE 2        // Queue entries reserved for the SMS lane
+
+#define NET_NOTIFY_T_UPDATE   0        // Entry type: full standard update
+#define NET_NOTIFY_T_STAT     1        // Entry type: status update (S+D)
+#define NET_NOTIFY_T_CHARGE   2        // Entry type: charge event
+#define NET_NOTIFY_T_12VLOW   3        // Entry type: 12V alert event
+#define NET_NOTIFY_T_TRUNK    4        // Entry type: trunk open
+#define NET_NOTIFY_T_ALARM    5        // Entry type: alarm sounding
+#define NET_NOTIFY_T_CARON    6        // Entry type: car is turned on
+#define NET_NOTIFY_T_STREAM   7        // Entry type: stream update for Apps
+#define NET_NOTIFY_T_ERROR    8        // Entry type: error code alert (IP only)
+#define NET_NOTIFY_TYPE       0x0f     // Mask for the entry type
+#define NET_NOTIFY_LANE_SMS   0x80     // Entry flag: SMS lane (else IP lane)
+#define NET_NOTIFY_FREE       0xff     // Entry type of an unused queue entry
+
+typedef struct {
+  unsigned char type;       // NET_NOTIFY_T_* + lane flag, NET_NOTIFY_FREE if unused
+  unsigned int  since;      // Time of first request (net_notify_secs)
+  unsigned int  errorcode;  // Payload for NET_NOTIFY_T_ERROR: error code
+  unsigned long errordata;  // Payload for NET_NOTIFY_T_ERROR: ancilliary data
+} net_notify_entry;
+
+extern net_notify_entry net_notify_queue[NET_NOTIFY_QUEUE]; // Notifications outstanding
+extern unsigned int  net_notify_secs;          // Seconds counter for notification timing
+extern unsigned int  net_notify_latcnt[NET_NOTIFY_PRIOS]; // Notifications sent by priority
+extern unsigned long net_notify_latsum[NET_NOTIFY_PRIOS]; // Sum of request to send times (s)
+extern unsigned int  net_notify_latmax[NET_NOTIFY_PRIOS]; // Max request to send time (s)
+extern unsigned char net_notify_dropped;       // Requests lost on a full queue
 extern unsigned int  net_notify_lasterrorcode; // Last error code to be notified
 extern unsigned char net_notify_lastcount;     // A counter used to clear error codes
-extern unsigned int  net_notify;               // Bitmap of notifications outstanding
+#ifdef OVMS_FASTBAUD
+#define NET_BAUD_FAST 57600
+// BRG16=1, BRGH=1: baud = Fosc / (4 * (SPBRG+1))
+#define NET_SPBRG_FAST ((UART_CLOCK_FREQ + 2*NET_BAUD_FAST) / (4*NET_BAUD_FAST) - 1)
+extern unsigned char net_baud_fast;            // 1 = UART running at NET_BAUD_FAST
+#endif // OVMS_FASTBAUD
+extern unsigned int  net_reconn_cnt[3];        // Recovery attempts by tier (TCP, GPRS, modem)
+extern unsigned long net_uart_bytes;           // Modem UART bytes exchanged (TX+RX) since FIRSTRUN
+extern unsigned int  net_conn_tready;          // Seconds FIRSTRUN / connection loss -> READY (0 = not yet)
+extern unsigned int  net_conn_tlogin;          // Seconds FIRSTRUN / connection loss -> server login (0 = not yet)
+extern unsigned long net_conn_bytes;           // UART bytes exchanged until the last server login
+extern unsigned long net_tx_blocked;           // Time spent waiting for TX buffer space (TMR0 ticks)
+extern unsigned char net_tx_hiwater;           // Max TX buffer fill level
+extern unsigned char net_rx_hiwater;           // Max RX buffer fill level
 extern unsigned char net_notify_suppresscount; // To suppress STAT notifications (seconds)
 
-#define NET_NOTIFY_NETPART    0x00ff   // Mask for the NET part
-#define NET_NOTIFY_SMSPART    0x7c00   // Mask for the SMS part
-
-#define NET_NOTIFY_NET_UPDATE 0x0001   // Set to 1 to send full standard update
-#define NET_NOTIFY_NET_STAT   0x0002   // Set to 1 to send status update (S+D)
-#define NET_NOTIFY_NET_CHARGE 0x0004   // Set to 1 to NET notify charge event
-#define NET_NOTIFY_NET_12VLOW 0x0008   // Set to 1 to NET notify 12V alert event
-#define NET_NOTIFY_NET_TRUNK  0x0010   // Set to 1 to NET notify trunk open
-#define NET_NOTIFY_NET_ALARM  0x0020   // Set to 1 to NET notify alarm sounding
-#define NET_NOTIFY_NET_CARON  0x0040   // Set to 1 to NET notify car is turned on
-#define NET_NOTIFY_NET_STREAM 0x0080   // Set to 1 to send stream update for Apps
-
-#define NET_NOTIFY_SMS_UPDATE 0x0100   // NOT IMPLEMENTED / REQUIRED
-#define NET_NOTIFY_SMS_STAT   0x0200   // NOT IMPLEMENTED / REQUIRED
-#define NET_NOTIFY_SMS_CHARGE 0x0400   // Set to 1 to SMS notify charge event
-#define NET_NOTIFY_SMS_12VLOW 0x0800   // Set to 1 to SMS notify 12V alert event
-#define NET_NOTIFY_SMS_TRUNK  0x1000   // Set to 1 to SMS notify trunk open
-#define NET_NOTIFY_SMS_ALARM  0x2000   // Set to 1 to SMS notify alarm sounding
-#define NET_NOTIFY_SMS_CARON  0x4000   // Set to 1 to SMS notify car is turned on
-#define NET_NOTIFY_SMS_STREAM 0x8000   // NOT IMPLEMENTED / REQUIRED
-
-// Convenience constants for net_notify() call
+// Request bits for net_req_notification(), bit number = entry type:
+#define NET_NOTIFY_NET_UPDATE 0x0001   // Send full standard update
+#define NET_NOTIFY_NET_STAT   0x0002   // Send status update (S+D)
+#define NET_NOTIFY_NET_CHARGE 0x0004   // Notify charge event
+#define NET_NOTIFY_NET_12VLOW 0x0008   // Notify 12V alert event
+#define NET_NOTIFY_NET_TRUNK  0x0010   // Notify trunk open
+#define NET_NOTIFY_NET_ALARM  0x0020   // Notify alarm sounding
+#define NET_NOTIFY_NET_CARON  0x0040   // Notify car is turned on
+#define NET_NOTIFY_NET_STREAM 0x0080   // Send stream update for Apps
+#define NET_NOTIFY_SMSTYPES   0x007c   // Types also available as SMS
+
+// Convenience constants for net_req_notification() call
 #define NET_NOTIFY_UPDATE     NET_NOTIFY_NET_UPDATE
 #define NET_NOTIFY_STAT       NET_NOTIFY_NET_STAT
 #define NET_NOTIFY_ENV        NET_NOTIFY_NET_STAT
@@ -199,6 +250,8 @@ extern char net_buf[NET_BUF_MAX];
 void net_puts_rom(const rom char *data);
 void net_puts_ram(const char *data);
 void net_putc_ram(const char data);
+BOOL net_tx_room(unsigned int len);
+BOOL net_tx_puts_ram(const char *data);
 
 void net_initialise(void);
 void net_poll(void);
@@ -215,6 +268,7 @@ void net_state_ticker(void);
 
 void net_req_notification_error(unsigned int errorcode, unsigned long errordata);
 void net_req_notification(unsigned int notify);
+BOOL net_notify_cancel(unsigned char type);
 
 char *net_assert_caller(char *caller);
 
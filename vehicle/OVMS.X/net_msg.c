@@ -57,6 +57,21 @@ INT8 net_msg_sendpending = 0;
 char token[23] = {0};
 char ptoken[23] = {0};
 char ptokenmade = 0;
+char pm_primed = 0; // pm_crypto holds the primed state for pdigest
+unsigned char net_msg_enc_buf[3]; // streaming encoder (tx layer)
+unsigned char net_msg_enc_len;
+unsigned char net_msg_pm_buf[3];  // streaming encoder (paranoid layer)
+unsigned char net_msg_pm_len;
+int net_msg_pm_cnt;
+char net_msg_txbatch = 0;          // Collecting messages into one CIPSEND
+char net_msg_txopen = 0;           // CIPSEND transaction in progress
+unsigned int net_msg_txbytes = 0;  // Bytes in the current transaction
+unsigned long net_msg_txcnt = 0;   // CIPSEND transactions
+unsigned long net_msg_txtotal = 0; // ...and their bytes
+#ifdef OVMS_BINMSG
+char net_msg_binary = 0;         // Server accepts binary records
+unsigned char net_msg_binlen = 0; // Binary record length in net_scratchpad
+#endif //OVMS_BINMSG
 char digest[MD5_SIZE];
 char pdigest[MD5_SIZE];
 WORD crc_stat = 0;
@@ -89,6 +104,20 @@ RC4_CTX1 tx_crypto1;
 RC4_CTX1 rx_crypto1;
 RC4_CTX1 pm_crypto1;
 
+#ifdef OVMS_DELTAMSG
+// Delta messages: per field CRCs of the last S, D and L records sent
+#define NET_MSG_DELTA_KEYFRAME 20   // Send full record at least every n msgs
+#define NET_MSG_DELTA_TYPES 3
+rom char net_msg_delta_code[NET_MSG_DELTA_TYPES] = { 'S', 'D', 'L' };
+rom UINT8 net_msg_delta_ofs[NET_MSG_DELTA_TYPES] = { 0, 48, 72 };
+rom UINT8 net_msg_delta_max[NET_MSG_DELTA_TYPES] = { 48, 24, 16 };
+#pragma udata NETMSG_DELTA
+WORD net_msg_delta_fcrc[88];
+UINT8 net_msg_delta_fcnt[NET_MSG_DELTA_TYPES]; // Fields in base record (0 = none)
+UINT8 net_msg_delta_seq[NET_MSG_DELTA_TYPES];  // Deltas left until next full record
+#pragma udata
+#endif //OVMS_DELTAMSG
+
 rom char NET_MSG_CMDRESP[] = "MP-0 c";
 rom char NET_MSG_CMDOK[] = ",0";
 rom char NET_MSG_CMDINVALIDSYNTAX[] = ",1,Invalid syntax";
@@ -106,18 +135,33 @@ void net_msg_init(void)
   net_msg_cmd_code = 0;
   net_msg_bufpos = NULL;
   net_apps_connected = 0;
+#ifdef OVMS_DELTAMSG
+  memset(net_msg_delta_fcnt, 0, sizeof(net_msg_delta_fcnt));
+#endif //OVMS_DELTAMSG
   }
 
 void net_msg_disconnected(void)
   {
   net_msg_serverok = 0;
   net_msg_sendpending = 0;
+  net_msg_txbatch = 0;
+  net_msg_txopen = 0;
   net_apps_connected = 0;
+#ifdef OVMS_DELTAMSG
+  // Start with full records on the next connection:
+  memset(net_msg_delta_fcnt, 0, sizeof(net_msg_delta_fcnt));
+#endif //OVMS_DELTAMSG
   }
 
 // Start to send a net msg
+// In batch mode, an open transaction is continued.
 void net_msg_start(void)
   {
+  if ((net_msg_txbatch) && (net_msg_txopen))
+    return;
+  net_msg_txopen = 1;
+  net_msg_txbytes = 0;
+  net_msg_txcnt++;
   if (net_state == NET_STATE_DIAGMODE)
     {
     net_msg_sendpending = 1;
@@ -132,8 +176,16 @@ void net_msg_start(void)
   }
 
 // Finish sending a net msg
+// In batch mode, the transaction is left open for more messages.
 void net_msg_send(void)
   {
+  if (net_msg_txbatch)
+    return;
+  if (net_msg_txopen)
+    {
+    net_msg_txopen = 0;
+    net_msg_txtotal += net_msg_txbytes;
+    }
   if (net_state == NET_STATE_DIAGMODE)
     {
     net_msg_sendpending = 0;
@@ -143,14 +195,137 @@ void net_msg_send(void)
     {
     // Submit / Abort:
     net_puts_rom(net_msg_sendpending ? "\x1a" : "\x1b");
+#ifdef OVMS_DELTAMSG
+    // Aborted records did not reach the server, next ones must be full:
+    if (!net_msg_sendpending)
+      memset(net_msg_delta_fcnt, 0, sizeof(net_msg_delta_fcnt));
+#endif //OVMS_DELTAMSG
+    }
+  }
+
+// Collect all following messages into one transaction, saving the
+// CIPSEND prompt round trip per message. Use net_msg_batch_room() to
+// check for space before adding a message.
+void net_msg_batch_begin(void)
+  {
+  net_msg_txbatch = 1;
+  }
+
+// Submit the collected messages
+void net_msg_batch_end(void)
+  {
+  net_msg_txbatch = 0;
+  if (net_msg_txopen)
+    net_msg_send();
+  }
+
+// Space left in the current transaction for <n> more messages?
+BOOL net_msg_batch_room(unsigned char n)
+  {
+  if (!net_msg_txopen)
+    return (n * NET_MSG_TXMSG) <= NET_MSG_TXMAX;
+  else if (!net_msg_sendpending)
+    return FALSE; // no prompt: don't queue more messages
+  else
+    return (net_msg_txbytes + n * NET_MSG_TXMSG) <= NET_MSG_TXMAX;
+  }
+
+// Setup and prime the paranoid mode crypto for pdigest.
+// Every paranoid message starts from this state, so it is kept and
+// restored by RC4_rewind() after use instead of doing a new setup
+// and 1KB discard per message.
+void net_msg_pm_prime(void)
+  {
+  int k;
+  char c;
+
+  RC4_setup(&pm_crypto1, &pm_crypto2, pdigest, MD5_SIZE);
+  for (k=0;k<1024;k++)
+    {
+    c = 0;
+    RC4_crypt(&pm_crypto1, &pm_crypto2, &c, 1);
+    }
+  pm_primed = 1;
+  }
+
+// Streaming message encoder: characters are collected in 3 byte groups,
+// each group is RC4 encrypted (tx_crypto) and sent base64 encoded.
+// The paranoid layer does the same with pm_crypto, feeding its base64
+// output into the tx layer, so no intermediate buffers are needed.
+// The base64 groups are sent by net_puts_ram (net_tx_puts_ram), so each
+// group is queued in one piece if the UART TX buffer has room.
+void net_msg_encode_putc(char c)
+  {
+  unsigned char out[5];
+
+  net_msg_enc_buf[net_msg_enc_len++] = c;
+  if (net_msg_enc_len == 3)
+    {
+    RC4_crypt(&tx_crypto1, &tx_crypto2, net_msg_enc_buf, 3);
+    encodeblock(net_msg_enc_buf, out, 3);
+    out[4] = 0;
+    net_puts_ram((char*)out);
+    net_msg_enc_len = 0;
+    net_msg_txbytes += 4;
+    }
+  }
+
+void net_msg_encode_flush(void)
+  {
+  unsigned char out[5];
+  unsigned char k;
+
+  if (net_msg_enc_len > 0)
+    {
+    RC4_crypt(&tx_crypto1, &tx_crypto2, net_msg_enc_buf, net_msg_enc_len);
+    for (k=net_msg_enc_len;k<3;k++) net_msg_enc_buf[k] = 0;
+    encodeblock(net_msg_enc_buf, out, net_msg_enc_len);
+    out[4] = 0;
+    net_puts_ram((char*)out);
+    net_msg_enc_len = 0;
+    net_msg_txbytes += 4;
+    }
+  }
+
+void net_msg_encode_pmputc(char c)
+  {
+  unsigned char out[4];
+  unsigned char k;
+
+  net_msg_pm_buf[net_msg_pm_len++] = c;
+  net_msg_pm_cnt++;
+  if (net_msg_pm_len == 3)
+    {
+    RC4_crypt(&pm_crypto1, &pm_crypto2, net_msg_pm_buf, 3);
+    encodeblock(net_msg_pm_buf, out, 3);
+    for (k=0;k<4;k++) net_msg_encode_putc(out[k]);
+    net_msg_pm_len = 0;
     }
   }
 
+void net_msg_encode_pmflush(void)
+  {
+  unsigned char out[4];
+  unsigned char k;
+
+  if (net_msg_pm_len > 0)
+    {
+    RC4_crypt(&pm_crypto1, &pm_crypto2, net_msg_pm_buf, net_msg_pm_len);
+    for (k=net_msg_pm_len;k<3;k++) net_msg_pm_buf[k] = 0;
+    encodeblock(net_msg_pm_buf, out, net_msg_pm_len);
+    for (k=0;k<4;k++) net_msg_encode_putc(out[k]);
+    net_msg_pm_len = 0;
+    }
+  // Restore the primed state for the next message:
+  RC4_rewind(&pm_crypto1, &pm_crypto2, net_msg_pm_cnt);
+  net_msg_pm_cnt = 0;
+  }
+
 // Encode the message in net_scratchpad and start the send process
 void net_msg_encode_puts(void)
   {
-  int k;
-  char code;
+  char *s;
+  char const rom far *r;
 
   if (!net_msg_sendpending)
     return;
@@ -158,9 +333,11 @@ void net_msg_encode_puts(void)
   if (net_state == NET_STATE_DIAGMODE)
     {
     net_puts_ram(net_scratchpad);
+    net_msg_txbytes += strlen(net_scratchpad);
     }
   else
     {
+    net_msg_enc_len = 0;
     if ((ptokenmade==1)&&
         (net_scratchpad[5]!='E')&&
         (net_scratchpad[5]!='A')&&
@@ -171,32 +348,38 @@ void net_msg_encode_puts(void)
       // We must convert the message to a paranoid one...
       // The message in net_scratchpad is of the form MP-0 X...
       // Where X is the code and ... is the (optional) data
-      // Let's rebuild it in the net_msg_scratchpad...
-      code = net_scratchpad[5];
-      strcpy(net_msg_scratchpad,net_scratchpad+6);
-
-      // Paranoid encrypt the message part of the transaction
-      RC4_setup(&pm_crypto1, &pm_crypto2, pdigest, MD5_SIZE);
-      for (k=0;k<1024;k++)
-        {
-        net_scratchpad[0] = 0;
-        RC4_crypt(&pm_crypto1, &pm_crypto2, net_scratchpad, 1);
-        }
-      k=strlen(net_msg_scratchpad);
-      RC4_crypt(&pm_crypto1, &pm_crypto2, net_msg_scratchpad, k);
-
-      stp_rom(net_scratchpad,(char const rom far*)"MP-0 EM");
-      net_scratchpad[7] = code;
-      base64encode(net_msg_scratchpad,k,net_scratchpad+8);
-      // The messdage is now in paranoid mode...
+      // It is sent as MP-0 EMX followed by the paranoid encrypted data
+      if (!pm_primed)
+        net_msg_pm_prime();
+      for (r=(char const rom far*)"MP-0 EM";*r;r++)
+        net_msg_encode_putc(*r);
+      net_msg_encode_putc(net_scratchpad[5]);
+      net_msg_pm_len = 0;
+      net_msg_pm_cnt = 0;
+      for (s=net_scratchpad+6;*s;s++)
+        net_msg_encode_pmputc(*s);
+      net_msg_encode_pmflush();
       }
-
-    k=strlen(net_scratchpad);
-    RC4_crypt(&tx_crypto1, &tx_crypto2, net_scratchpad, k);
-    base64encodesend(net_scratchpad,k);
+#ifdef OVMS_BINMSG
+    else if (net_msg_binlen)
+      {
+      for (s=net_scratchpad;s<net_scratchpad+net_msg_binlen;s++)
+        net_msg_encode_putc(*s);
+      }
+#endif //OVMS_BINMSG
+    else
+      {
+      for (s=net_scratchpad;*s;s++)
+        net_msg_encode_putc(*s);
+      }
+    net_msg_encode_flush();
     }
+#ifdef OVMS_BINMSG
+  net_msg_binlen = 0;
+#endif //OVMS_BINMSG
 
   net_puts_rom("\r\n");
+  net_msg_txbytes += 2;
   }
 
 // Register to the NET OVMS server
@@ -230,6 +413,9 @@ void net_msg_register(void)
   net_puts_rom(" ");
   p = par_get(PARAM_VEHICLEID);
   net_puts_ram(p);
+#ifdef OVMS_BINMSG
+  net_puts_rom(" B1"); // offer binary records
+#endif //OVMS_BINMSG
   net_puts_rom("\r\n");
   }
 
@@ -250,10 +436,191 @@ void net_msg_register(void)
 // sets stat=2 and calls the functions one after the other, setting stat with the result of the call
 // At the end, if stat=1, call net_msg_send().
 
+#ifdef OVMS_DELTAMSG
+// Convert the S, D or L record in net_scratchpad to a delta message
+// if that is shorter, and remember the field CRCs for the next one.
+// Not in SMS wrapper mode: the record goes to the SMS reply, and the
+// wrapper holds the command in net_msg_scratchpad (net_msg_cmd_exec).
+void net_msg_delta_encode(void)
+  {
+  UINT8 type, n, i;
+  WORD *fcrc, h;
+  char *p, *f, *d, *end;
+  BOOL full;
+
+  if ((net_state == NET_STATE_DIAGMODE) || (net_msg_bufpos))
+    return;
+  for (type=0; type<NET_MSG_DELTA_TYPES; type++)
+    if (net_scratchpad[5] == net_msg_delta_code[type]) break;
+  if (type == NET_MSG_DELTA_TYPES)
+    return;
+  if ((!net_msg_sendpending) || (ptokenmade))
+    {
+    // Not sent (no CIPSEND prompt), or the server cannot expand
+    // deltas against paranoid records:
+    net_msg_delta_fcnt[type] = 0;
+    return;
+    }
+
+  // Count fields:
+  for (n=1, p=net_scratchpad+6; *p; p++)
+    if (*p == ',') n++;
+  end = p;
+  if (n > net_msg_delta_max[type])
+    {
+    net_msg_delta_fcnt[type] = 0;
+    return;
+    }
+  full = ((n != net_msg_delta_fcnt[type]) || (net_msg_delta_seq[type] == 0));
+  fcrc = net_msg_delta_fcrc + net_msg_delta_ofs[type];
+
+  d = stp_rom(net_msg_scratchpad, "MP-0 d");
+  *d++ = net_scratchpad[5];
+  d = stp_i(d, NULL, n);
+  for (i=0, f=p=net_scratchpad+6; ; p++)
+    {
+    if ((*p == ',') || (*p == 0))
+      {
+      h = crc16(f, p-f);
+      if ((!full) && (h != fcrc[i]))
+        {
+        // Delta must stay shorter than the full record:
+        if ((d - net_msg_scratchpad) + (p - f) + 5 >= (end - net_scratchpad))
+          full = TRUE;
+        else
+          {
+          d = stp_i(d, ",", i);
+          *d++ = ',';
+          while (f < p) *d++ = *f++;
+          }
+        }
+      fcrc[i++] = h;
+      if (*p == 0) break;
+      f = p + 1;
+      }
+    }
+  *d = 0;
+  net_msg_delta_fcnt[type] = n;
+
+  if (full)
+    {
+    net_msg_delta_seq[type] = NET_MSG_DELTA_KEYFRAME;
+    }
+  else
+    {
+    net_msg_delta_seq[type]--;
+    strcpy(net_scratchpad, net_msg_scratchpad);
+    }
+  }
+#endif //OVMS_DELTAMSG
+
+#ifdef OVMS_BINMSG
+// Convert the S, D, L or W record in net_scratchpad to binary form:
+//  "MP-0 b<code>" followed by one token per field:
+//    0x00-0x3F   integer 0..63
+//    0x40        integer, zigzag varint follows
+//    0x41-0x47   decimal with 1..7 fraction digits, zigzag varint of
+//                the digits follows (i.e. "-1.25" = 0x42 varint(-125))
+//    0x48        empty field
+//    0x80-0xFF   string of (token & 0x7F) chars follows
+//  Varints: 7 bits per byte, LSB first, bit 7 set = more bytes follow.
+//  Numbers not in canonical form (leading zeros etc.) are sent as strings.
+// The binary record is left in net_scratchpad, length in net_msg_binlen.
+void net_msg_bin_encode(void)
+  {
+  char *p, *f, *q, *d;
+  signed char neg, dec, nd;
+  unsigned long v;
+
+  if ((!net_msg_binary) || (ptokenmade) || (net_state == NET_STATE_DIAGMODE)
+      || (net_msg_bufpos))
+    return; // (SMS wrapper mode: see net_msg_delta_encode)
+  if ((net_scratchpad[5] != 'S') && (net_scratchpad[5] != 'D') &&
+      (net_scratchpad[5] != 'L') && (net_scratchpad[5] != 'W'))
+    return;
+
+  d = stp_rom(net_msg_scratchpad, "MP-0 b");
+  *d++ = net_scratchpad[5];
+  for (f=p=net_scratchpad+6; ; p++)
+    {
+    if ((*p != ',') && (*p != 0))
+      continue;
+
+    if (d >= net_msg_scratchpad + NET_BUF_MAX - 8)
+      return; // too long, send as text
+
+    // Try to parse field as a number:
+    neg = (*f == '-');
+    q = f + neg;
+    v = 0; dec = -1; nd = 0;
+    if ((*q == '0') && (q[1] >= '0') && (q[1] <= '9'))
+      q = p; // leading zero: string
+    else if (q == p)
+      nd = -1; // no digits: string
+    for (; q < p; q++)
+      {
+      if ((*q >= '0') && (*q <= '9') && (nd < 9))
+        {
+        v = v * 10 + (*q - '0');
+        nd++;
+        if (dec >= 0) dec++;
+        }
+      else if ((*q == '.') && (dec < 0) && (nd > 0))
+        dec = 0;
+      else
+        break;
+      }
+
+    if (p == f)
+      {
+      *d++ = 0x48;
+      }
+    else if ((q == p) && (nd > 0) && (dec != 0) && (dec <= 7) && !(neg && (v == 0)))
+      {
+      if ((!neg) && (dec < 0) && (v < 0x40))
+        *d++ = v;
+      else
+        {
+        *d++ = 0x40 + ((dec < 0) ? 0 : dec);
+        v = (neg) ? (v << 1) - 1 : (v << 1);
+        while (v >= 0x80)
+          {
+          *d++ = (v & 0x7f) | 0x80;
+          v >>= 7;
+          }
+        *d++ = v;
+        }
+      }
+    else
+      {
+      if ((p - f) > 0x7f)
+        return; // send as text
+      *d++ = 0x80 | (p - f);
+      while (f < p) *d++ = *f++;
+      }
+
+    if (*p == 0) break;
+    f = p + 1;
+    }
+
+  net_msg_binlen = d - net_msg_scratchpad;
+  memcpy(net_scratchpad, net_msg_scratchpad, net_msg_binlen);
+  }
+#endif //OVMS_BINMSG
+
 // <stat> guarded encode the message in net_scratchpad and start the send process
 char net_msg_encode_statputs(char stat, WORD *oldcrc)
   {
-  WORD newcrc = crc16(net_scratchpad, strlen(net_scratchpad));
+  WORD newcrc = crc16_str(net_scratchpad);
+
+#ifdef OVMS_DELTAMSG
+  if ((stat == 0) || (*oldcrc != newcrc))
+    net_msg_delta_encode();
+#endif //OVMS_DELTAMSG
+#ifdef OVMS_BINMSG
+  if ((stat == 0) || (*oldcrc != newcrc))
+    net_msg_bin_encode();
+#endif //OVMS_BINMSG
 
   switch (stat)
     {
@@ -286,12 +653,15 @@ char net_msg_encode_statputs(char stat, WORD *oldcrc)
 
 char net_msgp_stat(char stat)
 {
-  char *p, *s;
+  char *s;
+  char units[2];
 
-  p = par_get(PARAM_MILESKM);
+  // PARAM_MILESKM, cached by vehicle_initialise() & par_cache():
+  units[0] = can_mileskm;
+  units[1] = 0;
 
   s = stp_i(net_scratchpad, "MP-0 S", car_SOC);
-  s = stp_s(s, ",", p);
+  s = stp_s(s, ",", units);
   s = stp_i(s, ",", car_linevoltage);
   s = stp_i(s, ",", car_chargecurrent);
 
@@ -334,7 +704,7 @@ char net_msgp_stat(char stat)
     s = stp_rom(s, ",");
   }
 
-  if (*p == 'M') // Kmh or Miles
+  if (can_mileskm == 'M') // Kmh or Miles
   {
     s = stp_i(s, ",", car_idealrange);
     s = stp_i(s, ",", car_estrange);
@@ -362,7 +732,7 @@ char net_msgp_stat(char stat)
           && (car_chargelimit_minsremaining_range < car_chargelimit_minsremaining_soc))
           ? car_chargelimit_minsremaining_range
           : car_chargelimit_minsremaining_soc); // ETR for first limit reached
-  s = stp_i(s, ",", (*p == 'M')
+  s = stp_i(s, ",", (can_mileskm == 'M')
           ? car_chargelimit_rangelimit
           : KmFromMi(car_chargelimit_rangelimit));
   s = stp_i(s, ",", car_chargelimit_soclimit);
@@ -376,7 +746,7 @@ char net_msgp_stat(char stat)
   s = stp_i(s, ",", car_chargeestimate);
   s = stp_i(s, ",", car_chargelimit_minsremaining_range);
   s = stp_i(s, ",", car_chargelimit_minsremaining_soc);
-  s = stp_i(s, ",", (*p == 'M')
+  s = stp_i(s, ",", (can_mileskm == 'M')
           ? car_max_idealrange
           : KmFromMi(car_max_idealrange));
   s = stp_i(s, ",", car_chargetype);
@@ -520,7 +890,11 @@ char net_msgp_capabilities(char stat)
     s = stp_rom(s, can_capabilities);
     s = stp_rom(s, ",");
   }
+#ifdef OVMS_POLLER
+  s = stp_rom(s, "C1-6,C8-9,C40-41,C49");
+#else
   s = stp_rom(s, "C1-6,C40-41,C49");
+#endif
 
   return net_msg_encode_statputs(stat, &crc_capabilities);
 }
@@ -565,6 +939,18 @@ void net_msg_server_welcome(char *msg)
   if (*d != ' ') return;
   *d++ = 0;
 
+#ifdef OVMS_BINMSG
+  // Optional server options after the digest:
+  net_msg_binary = 0;
+  for (s=d;(*s != 0)&&(*s != ' ');s++) ;
+  if (*s == ' ')
+    {
+    *s++ = 0;
+    if (strcmppgm2ram(s, (char const rom far*)"B1") == 0)
+      net_msg_binary = 1;
+    }
+#endif //OVMS_BINMSG
+
   // At this point, <msg> is token, and <x> is base64digest
   // (both null-terminated)
 
@@ -626,6 +1012,7 @@ void net_msg_server_welcome(char *msg)
     // And calculate the pdigest for future use
     p = par_get(PARAM_MODULEPASS);
     hmac_md5(ptoken, strlen(ptoken), p, strlen(p), pdigest);
+    net_msg_pm_prime();
     }
   else
     {
@@ -700,13 +1087,10 @@ void net_msg_in(char* msg)
     // A paranoid-mode message from the server (or, more specifically, app)
     msg += 2; // Now pointing to the code just before encrypted paranoid message
     k = base64decode(msg+1,net_msg_scratchpad+1);
-    RC4_setup(&pm_crypto1, &pm_crypto2, pdigest, MD5_SIZE);
-    for (k=0;k<1024;k++)
-      {
-      net_scratchpad[0] = 0;
-      RC4_crypt(&pm_crypto1, &pm_crypto2, net_scratchpad, 1);
-      }
+    if (!pm_primed)
+      net_msg_pm_prime();
     RC4_crypt(&pm_crypto1, &pm_crypto2, net_msg_scratchpad+1, k);
+    RC4_rewind(&pm_crypto1, &pm_crypto2, k);
     net_msg_scratchpad[0] = *msg; // The code
     // The message is now out of paranoid mode...
     msg = net_msg_scratchpad;
@@ -769,9 +1153,22 @@ void net_msg_cmd_in(char* msg)
   net_msg_cmd_msg = d;
   }
 
+// Set a feature, shared by MSG command 2 and SMS command FEATURE
+// Returns FALSE if the feature number is invalid.
+BOOL net_msg_setfeature(unsigned char f, char *value)
+  {
+  if (f >= FEATURES_MAX)
+    return FALSE;
+  sys_features[f] = atoi(value);
+  if (f>=FEATURES_MAP_PARAM) // Top N features are persistent
+    par_set(PARAM_FEATURE_S+(f-FEATURES_MAP_PARAM), value);
+  if (f == FEATURE_CANWRITE) vehicle_initialise();
+  return TRUE;
+  }
+
 BOOL net_msg_cmd_exec(void)
   {
-  UINT8 k;
+  UINT8 k, i;
   char *p, *s;
 
   CHECKPOINT(0x43)
@@ -789,19 +1186,12 @@ BOOL net_msg_cmd_exec(void)
       break;
 
     case 2: // Set feature (params: feature number, value)
-      for (p=net_msg_cmd_msg;(*p != 0)&&(*p != ',');p++) ;
-      // check if a value exists and is separated by a comma
-      if (*p == ',')
+      s = firstarg(net_msg_cmd_msg, ',');
+      p = nextarg(s);
+      if (p != NULL)
         {
-        *p++ = 0;
-        // At this point, <net_msg_cmd_msg> points to the command, and <p> to the param value
-        k = atoi(net_msg_cmd_msg);
-        if ((k>=0)&&(k<FEATURES_MAX))
+        if (net_msg_setfeature(atoi(s), p))
           {
-          sys_features[k] = atoi(p);
-          if (k>=FEATURES_MAP_PARAM) // Top N features are persistent
-            par_set(PARAM_FEATURE_S+(k-FEATURES_MAP_PARAM), p);
-          if (k == FEATURE_CANWRITE) vehicle_initialise();
           STP_OK(net_scratchpad, net_msg_cmd_code);
           }
         else
@@ -829,13 +1219,12 @@ BOOL net_msg_cmd_exec(void)
       break;
 
     case 4: // Set parameter (params: param number, value)
-      for (p=net_msg_cmd_msg;(*p != 0)&&(*p != ',');p++) ;
-      // check if a value exists and is separated by a comma
-      if (*p == ',')
+      // the value is the rest of the line (may contain commas):
+      s = firstarg(net_msg_cmd_msg, ',');
+      p = restarg(s);
+      if (p != NULL)
         {
-        *p++ = 0;
-        // At this point, <net_msg_cmd_msg> points to the command, and <p> to the param value
-        k = atoi(net_msg_cmd_msg);
+        k = atoi(s);
         // Check validity of param key and value (no empty value allowed for auth params):
         if ( (k>=0) && (k<PARAM_FEATURE_S)
                 && ((k>PARAM_MODULEPASS) || (*p!=0)) )
@@ -912,14 +1301,81 @@ BOOL net_msg_cmd_exec(void)
       net_msg_encode_puts();
       break;
 
+#ifdef OVMS_POLLER
+    case 8: // Request poll statistics (params unused)
+      // per poll list entry: index, count, module, pid, requests, responses,
+      //  timeouts, response latency min, avg, max [ms]
+      if (vehicle_poll_plist == NULL)
+        {
+        STP_UNIMPLEMENTED(net_scratchpad, net_msg_cmd_code);
+        net_msg_encode_puts();
+        break;
+        }
+      for (k=0; (k<VEHICLE_POLL_MAXPIDS)&&(vehicle_poll_plist[k].moduleid != 0); k++) ;
+      for (i=0; i<k; i++)
+        {
+        s = stp_i(net_scratchpad, "MP-0 c8,0,", i);
+        s = stp_i(s, ",", k);
+        s = stp_x(s, ",", vehicle_poll_plist[i].moduleid);
+        s = stp_x(s, ",", vehicle_poll_plist[i].pid);
+        s = stp_ul(s, ",", vehicle_poll_stats[i].req);
+        s = stp_ul(s, ",", vehicle_poll_stats[i].resp);
+        s = stp_i(s, ",", vehicle_poll_stats[i].timeouts);
+        s = stp_i(s, ",", vehicle_poll_stats[i].latmin);
+        s = stp_i(s, ",", vehicle_poll_stats[i].latavg);
+        s = stp_i(s, ",", vehicle_poll_stats[i].latmax);
+        net_msg_encode_puts();
+        }
+      break;
+
+    case 9: // Poll list config (params: none = query, idx,enable[,time0,time1,time2] = set, -1 = reset)
+      k = vehicle_poll_count();
+      if (k == 0)
+        {
+        STP_UNIMPLEMENTED(net_scratchpad, net_msg_cmd_code);
+        net_msg_encode_puts();
+        break;
+        }
+      if (*net_msg_cmd_msg != 0)
+        {
+        switch (vehicle_poll_cfgcmd(firstarg(net_msg_cmd_msg, ',')))
+          {
+          case 0:
+            STP_OK(net_scratchpad, net_msg_cmd_code);
+            break;
+          case 1:
+            STP_INVALIDSYNTAX(net_scratchpad, net_msg_cmd_code);
+            break;
+          default:
+            STP_INVALIDRANGE(net_scratchpad, net_msg_cmd_code);
+            break;
+          }
+        net_msg_encode_puts();
+        break;
+        }
+      // per poll list entry: index, count, module, pid, enabled, time0, time1, time2
+      for (i=0; i<k; i++)
+        {
+        s = stp_i(net_scratchpad, "MP-0 c9,0,", i);
+        s = stp_i(s, ",", k);
+        s = stp_x(s, ",", vehicle_poll_plist[i].moduleid);
+        s = stp_x(s, ",", vehicle_poll_plist[i].pid);
+        s = stp_i(s, ",", vehicle_poll_isenabled(i));
+        s = stp_i(s, ",", vehicle_poll_cfgtime(i, 0));
+        s = stp_i(s, ",", vehicle_poll_cfgtime(i, 1));
+        s = stp_i(s, ",", vehicle_poll_cfgtime(i, 2));
+        net_msg_encode_puts();
+        }
+      break;
+#endif //OVMS_POLLER
+
     case 40: // Send SMS (params: phone number, SMS message)
-      for (p=net_msg_cmd_msg;(*p != 0)&&(*p != ',');p++) ;
-      // check if a value exists and is separated by a comma
-      if (*p == ',')
+      // the message is the rest of the line (may contain commas):
+      s = firstarg(net_msg_cmd_msg, ',');
+      p = restarg(s);
+      if (p != NULL)
         {
-        *p++ = 0;
-        // At this point, <net_msg_cmd_msg> points to the phone number, and <p> to the SMS message
-        net_send_sms_start(net_msg_cmd_msg);
+        net_send_sms_start(s);
         net_puts_ram(p);
         net_puts_rom("\x1a");
         delay100(5);
@@ -1358,3 +1814,47 @@ void net_msg_erroralert(unsigned int errorcode, unsigned long errordata)
   net_msg_send();
   }
 #endif // OVMS_NO_ERROR_NOTIFY
+
+#ifdef OVMS_CANSTATS
+/* CAN traffic statistics history records (stats are reset after sending):
+ *
+ * MP-0 H*-OVM-CANStats,0,604800
+ *  ,<seconds>,<kbps>,<frames_rxb0>,<frames_rxb1>,<fps_max>
+ *  ,<load_avg>,<load_max>,<ovfl_rxb0>,<ovfl_rxb1>
+ *
+ * MP-0 H*-OVM-CANTalkers,<rank>,604800
+ *  ,<id>,<frames>,<bytes>
+ */
+void net_msg_canstats(void)
+  {
+  vehicle_canstat_t e;
+  unsigned int done = 0;
+  unsigned char k;
+  char *s;
+
+  net_msg_start();
+
+  s = stp_i(net_scratchpad, "MP-0 H*-OVM-CANStats,0,604800,", vehicle_canstat_secs);
+  s = stp_i(s, ",", vehicle_canstat_kbps);
+  s = stp_ul(s, ",", vehicle_canstat_getframes(0));
+  s = stp_ul(s, ",", vehicle_canstat_getframes(1));
+  s = stp_i(s, ",", vehicle_canstat_fpsmax);
+  s = stp_i(s, ",", vehicle_canstat_loadavg);
+  s = stp_i(s, ",", vehicle_canstat_loadmax);
+  s = stp_i(s, ",", vehicle_can_overflow[0]);
+  s = stp_i(s, ",", vehicle_can_overflow[1]);
+  net_msg_encode_puts();
+
+  for (k=0; vehicle_canstat_top(&done, &e); k++)
+    {
+    s = stp_i(net_scratchpad, "MP-0 H*-OVM-CANTalkers,", k);
+    s = stp_x(s, ",604800,", e.id);
+    s = stp_ul(s, ",", e.frames);
+    s = stp_ul(s, ",", e.bytes);
+    net_msg_encode_puts();
+    }
+
+  net_msg_send();
+  vehicle_canstat_reset();
+  }
+#endif // OVMS_CANSTATS
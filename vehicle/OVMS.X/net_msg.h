@@ -58,17 +58,32 @@ extern INT8 net_msg_sendpending;            // flag & counter
 extern int  net_msg_cmd_code;               // currently processed msg command code
 extern char* net_msg_cmd_msg;               // ...and parameters, see  net_msg_cmd_in()
 
-extern char net_msg_scratchpad[NET_BUF_MAX]; // encoding buffer for paranoid mode
+extern char net_msg_scratchpad[NET_BUF_MAX]; // decoding buffer for paranoid mode
     // note: net_msg_scratchpad is only used as a temporary buffer
-    // by net_msg_encode_puts() -- it can be reused as a temp buffer
-    // in other places as long as net_msg_encode_puts() is not called.
+    // for incoming paranoid mode messages and the SMS command wrapper
+    // (net_msg_cmd_in(), net_msg_cmd_exec()) -- it can be reused as a
+    // temp buffer in other places.
 
 extern char *net_msg_bufpos; // write position in net_msg_scratchpad in wrapper mode
 
+// Transmit batching: several messages are sent in one CIPSEND transaction
+// up to NET_MSG_TXMAX bytes, each message can take up to NET_MSG_TXMSG
+// bytes (paranoid mode: base64 of base64 of NET_BUF_MAX + CRLF).
+// The SIM908 accepts up to 1352 bytes per CIPSEND, we keep some margin.
+#define NET_MSG_TXMAX   1024
+#define NET_MSG_TXMSG   364
+
+extern char net_msg_txopen;                 // CIPSEND transaction in progress
+extern unsigned long net_msg_txcnt;         // CIPSEND transactions
+extern unsigned long net_msg_txtotal;       // ...and their bytes
+
 void net_msg_init(void);
 void net_msg_disconnected(void);
 void net_msg_start(void);
 void net_msg_send(void);
+void net_msg_batch_begin(void);
+void net_msg_batch_end(void);
+BOOL net_msg_batch_room(unsigned char n);
 void net_msg_encode_puts(void);
 void net_msg_register(void);
 char net_msg_encode_statputs(char stat, WORD *oldcrc);
@@ -85,6 +100,7 @@ void net_send_stdupdate(void);
 void net_msg_in(char* msg);
 void net_msg_cmd_in(char* msg);
 void net_msg_cmd_do(void);
+BOOL net_msg_setfeature(unsigned char f, char *value);
 
 void net_msg_forward_sms(char* caller, char* SMS);
 void net_msg_reply_ussd(char *buf, unsigned char buflen);
@@ -94,6 +110,9 @@ char *net_prep_ctp(char *s, char *arguments);
 void net_msg_stat(void);
 void net_msg_alert(alert_type alert);
 void net_msg_erroralert(unsigned int errorcode, unsigned long errordata);
+#ifdef OVMS_CANSTATS
+void net_msg_canstats(void);
+#endif // OVMS_CANSTATS
 
 
 // Standard commands:
@@ -105,6 +124,8 @@ void net_msg_erroralert(unsigned int errorcode, unsigned long errordata);
 #define CMD_Reboot                      5   // ()
 #define CMD_Alert                       6   // ()
 #define CMD_Execute                     7   // (text command with arguments)
+#define CMD_QueryPollStats              8   // () (OVMS_POLLER builds only)
+#define CMD_PollConfig                  9   // ([idx,enable[,time0,time1,time2]] / -1) (OVMS_POLLER)
 
 #define CMD_SetChargeMode               10  // (mode)
 #define CMD_StartCharge                 11  // ()
@@ -44,6 +44,7 @@
 
 #pragma udata
 char *net_msg_bufpos; // buffer write position for net_put*
+unsigned char net_sms_cmdcode; // MSG command code of the SMS command in execution
 
 rom char NET_MSG_DENIED[] = "Permission denied";
 rom char NET_MSG_INVALID[] = "Invalid command";
@@ -660,33 +661,84 @@ BOOL net_sms_handle_server(char *caller, char *command, char *arguments)
   return serverq_result;
 }
 
+// Output a DIAG line from net_scratchpad (ending at s),
+// start the next SMS if the current one would exceed 160 chars.
+// Returns the new message length.
+unsigned char net_sms_diag_puts(char *caller, unsigned char msglen, char *s)
+{
+  unsigned char splen = s - net_scratchpad;
+
+  if ((msglen+splen) > 160)
+  {
+    // SMS becomes too long, finish & start next:
+    net_send_sms_finish();
+    delay100(20);
+    net_send_sms_start(caller);
+    net_puts_rom("DIAG:");
+    msglen = 5;
+  }
+  net_puts_ram(net_scratchpad);
+  return msglen + splen;
+}
+
 BOOL net_sms_handle_diag(char *caller, char *command, char *arguments)
 {
   char *s;
+  unsigned char k, msglen;
 
   if (sys_features[FEATURE_CARBITS] & FEATURE_CB_SOUT_SMS) return FALSE;
 
   net_send_sms_start(caller);
-
-  s = stp_rom(net_scratchpad, "DIAG:");
-  s = stp_i(s, "\n RED Led:", led_code[OVMS_LED_RED]);
-  s = stp_i(s, "\n GRN Led:", led_code[OVMS_LED_GRN]);
-  s = stp_sx(s, "\n NET State:0x", net_state);
+  net_puts_rom("DIAG:");
+  msglen = 5;
+
+  s = stp_i(net_scratchpad, "\n RED Led:", led_code[OVMS_LED_RED]);
+  msglen = net_sms_diag_puts(caller, msglen, s);
+  s = stp_i(net_scratchpad, "\n GRN Led:", led_code[OVMS_LED_GRN]);
+  msglen = net_sms_diag_puts(caller, msglen, s);
+  s = stp_sx(net_scratchpad, "\n NET State:0x", net_state);
+  msglen = net_sms_diag_puts(caller, msglen, s);
+  s = stp_i(net_scratchpad, "\n Connect:", net_conn_tready);
+  s = stp_i(s, "/", net_conn_tlogin);
+  s = stp_ul(s, "s ", net_conn_bytes);
+  s = stp_rom(s, "B");
+  msglen = net_sms_diag_puts(caller, msglen, s);
+  s = stp_i(net_scratchpad, "\n RX:", net_rx_hiwater);
+  s = stp_i(s, "/", RX_BUFFER_SIZE);
+  s = stp_ul(s, " ovfl:", vUARTIntRxOverFlowCnt);
+  msglen = net_sms_diag_puts(caller, msglen, s);
+  s = stp_i(net_scratchpad, "\n Reconn:", net_reconn_cnt[0]);
+  s = stp_i(s, "/", net_reconn_cnt[1]);
+  s = stp_i(s, "/", net_reconn_cnt[2]);
+  msglen = net_sms_diag_puts(caller, msglen, s);
+  s = stp_ul(net_scratchpad, "\n EE writes:", par_eewrites);
+  msglen = net_sms_diag_puts(caller, msglen, s);
+  s = stp_rom(net_scratchpad, "\n Notify:");
+  for (k=0; k<NET_NOTIFY_PRIOS; k++)
+  {
+    s = stp_ul(s, " ", (net_notify_latcnt[k] > 0)
+      ? (net_notify_latsum[k] / net_notify_latcnt[k]) : 0);
+    s = stp_i(s, "/", net_notify_latmax[k]);
+  }
+  s = stp_i(s, "s drop:", net_notify_dropped);
+  msglen = net_sms_diag_puts(caller, msglen, s);
 
   if (car_12vline > 0)
   {
-    s = stp_l2f(s, "\n 12V Line:", car_12vline, 1);
+    s = stp_l2f(net_scratchpad, "\n 12V Line:", car_12vline, 1);
     s = stp_l2f(s, " ref=", car_12vline_ref, 1);
     s = stp_l2f(s, " cur=", car_12v_current, 1);
+    msglen = net_sms_diag_puts(caller, msglen, s);
   }
 
 #ifndef OVMS_NO_CRASHDEBUG
   /* DEBUG / QA stats: output crash counter and decode last reason:
    */
-  s = stp_i(s, "\n Crashes:", debug_crashcnt);
+  s = stp_i(net_scratchpad, "\n Crashes:", debug_crashcnt);
+  msglen = net_sms_diag_puts(caller, msglen, s);
   if (debug_crashreason)
   {
-    s = stp_rom(s, "\n ..last:");
+    s = stp_rom(net_scratchpad, "\n ..last:");
     if (debug_crashreason & 0x01)
       s = stp_rom(s, " BOR"); // Brown Out Reset
     if (debug_crashreason & 0x02)
@@ -702,11 +754,10 @@ BOOL net_sms_handle_diag(char *caller, char *command, char *arguments)
     if (debug_crashreason & 0x40)
       s = stp_rom(s, " STKUNF"); // Stack underflow
     s = stp_i(s, " - ", debug_checkpoint);
+    msglen = net_sms_diag_puts(caller, msglen, s);
   }
 #endif // OVMS_NO_CRASHDEBUG
 
-  net_puts_ram(net_scratchpad);
-
   return TRUE;
 }
 
@@ -739,12 +790,8 @@ BOOL net_sms_handle_feature(char *caller, char *command, char *arguments)
 
   f = atoi(arguments);
   arguments = net_sms_nextarg(arguments);
-  if ((f>=0)&&(f<FEATURES_MAX)&&(arguments != NULL))
+  if ((arguments != NULL)&&(net_msg_setfeature(f, arguments)))
     {
-    sys_features[f] = atoi(arguments);
-    if (f>=FEATURES_MAP_PARAM) // Top N features are persistent
-      par_set(PARAM_FEATURE_S+(f-FEATURES_MAP_PARAM), arguments);
-    if (f == FEATURE_CANWRITE) vehicle_initialise();
     net_send_sms_start(caller);
     net_puts_rom(NET_MSG_FEATURE);
     return TRUE;
@@ -752,54 +799,63 @@ BOOL net_sms_handle_feature(char *caller, char *command, char *arguments)
   return FALSE;
   }
 
-#ifndef OVMS_NO_HOMELINK
-BOOL net_sms_handle_homelink(char *caller, char *command, char *arguments)
+// Execute an SMS command as its MSG command (net_sms_cmdcode, see
+// sms_codetable) by the vehicle module (and ACC module), reply with a
+// fixed text:
+BOOL net_sms_handle_cmd(char *caller, char *command, char *arguments)
   {
-  if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 24, arguments);
-  net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_HOMELINK);
-  return TRUE;
-  }
-#endif // OVMS_NO_HOMELINK
+  const rom char *reply;
 
+  switch (net_sms_cmdcode)
+    {
+#ifndef OVMS_NO_HOMELINK
+    case CMD_Homelink:
+      reply = NET_MSG_HOMELINK;
+      break;
+#endif // OVMS_NO_HOMELINK
 #ifndef OVMS_NO_LOCK
-BOOL net_sms_handle_lock(char *caller, char *command, char *arguments)
-  {
-  if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 20, arguments);
-  net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_LOCK);
-  return TRUE;
-  }
-
-BOOL net_sms_handle_unlock(char *caller, char *command, char *arguments)
-  {
-  if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 22, arguments);
-  net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_UNLOCK);
-  return TRUE;
-  }
+    case CMD_Lock:
+      reply = NET_MSG_LOCK;
+      break;
+    case CMD_UnLock:
+      reply = NET_MSG_UNLOCK;
+      break;
+    case CMD_ValetOn:
+      reply = NET_MSG_VALET;
+      break;
+    case CMD_ValetOff:
+      reply = NET_MSG_UNVALET;
+      break;
+#endif // OVMS_NO_LOCK
+#ifndef OVMS_NO_CHARGECONTROL
+    case CMD_StartCharge:
+      net_notify_suppresscount = 0; // Enable notifications
+      reply = NET_MSG_CHARGESTART;
+      arguments = NULL;
+      break;
+    case CMD_StopCharge:
+      net_notify_suppresscount = 30; // Suppress notifications for 30 seconds
+      reply = NET_MSG_CHARGESTOP;
+      arguments = NULL;
+      break;
+    case CMD_CoolDown:
+      reply = NET_MSG_COOLDOWN;
+      arguments = NULL;
+      break;
+#endif // OVMS_NO_CHARGECONTROL
+    default:
+      return FALSE;
+    }
 
-BOOL net_sms_handle_valet(char *caller, char *command, char *arguments)
-  {
   if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 21, arguments);
+    vehicle_fn_commandhandler(FALSE, net_sms_cmdcode, arguments);
   net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_VALET);
-  return TRUE;
-  }
-
-BOOL net_sms_handle_unvalet(char *caller, char *command, char *arguments)
-  {
-  if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 23, arguments);
-  net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_UNVALET);
+  net_puts_rom(reply);
+#ifdef OVMS_ACCMODULE
+  acc_handle_msg(FALSE, net_sms_cmdcode, NULL);
+#endif
   return TRUE;
   }
-#endif // OVMS_NO_LOCK
 
 #ifndef OVMS_NO_CHARGECONTROL
 
@@ -826,44 +882,6 @@ BOOL net_sms_handle_chargemode(char *caller, char *command, char *arguments)
   return TRUE;
   }
 
-BOOL net_sms_handle_chargestart(char *caller, char *command, char *arguments)
-  {
-  if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 11, NULL);
-  net_notify_suppresscount = 0; // Enable notifications
-  net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_CHARGESTART);
-#ifdef OVMS_ACCMODULE
-  acc_handle_msg(FALSE, 11, NULL);
-#endif
-  return TRUE;
-  }
-
-BOOL net_sms_handle_chargestop(char *caller, char *command, char *arguments)
-  {
-  if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 12, NULL);
-  net_notify_suppresscount = 30; // Suppress notifications for 30 seconds
-  net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_CHARGESTOP);
-#ifdef OVMS_ACCMODULE
-  acc_handle_msg(FALSE, 12, NULL);
-#endif
-  return TRUE;
-  }
-
-BOOL net_sms_handle_cooldown(char *caller, char *command, char *arguments)
-  {
-  if (vehicle_fn_commandhandler != NULL)
-    vehicle_fn_commandhandler(FALSE, 25, NULL);
-  net_send_sms_start(caller);
-  net_puts_rom(NET_MSG_COOLDOWN);
-#ifdef OVMS_ACCMODULE
-  acc_handle_msg(FALSE, 25, NULL);
-#endif
-  return TRUE;
-  }
-
 #endif // OVMS_NO_CHARGECONTROL
 
 
@@ -925,6 +943,50 @@ BOOL net_sms_handle_temps(char *caller, char *command, char *arguments)
   return TRUE;
   }
 
+#ifdef OVMS_POLLER
+// POLL                              -- show poll list size
+// POLL <idx>                        -- show entry config
+// POLL <idx> <enable> [<t0> <t1> <t2>] -- set entry config (t < 0 = default)
+// POLL -1                           -- reset config to poll list defaults
+BOOL net_sms_handle_poll(char *caller, char *command, char *arguments)
+  {
+  unsigned char k, n;
+  char *s;
+
+  if (sys_features[FEATURE_CARBITS]&FEATURE_CB_SOUT_SMS) return FALSE;
+
+  n = vehicle_poll_count();
+  if ((arguments != NULL)&&((arguments[0] == '-')||(net_sms_nextarg(arguments) != NULL)))
+    {
+    if (vehicle_poll_cfgcmd(arguments) != 0)
+      return FALSE;
+    }
+
+  if ((arguments == NULL)||(arguments[0] == '-'))
+    {
+    s = stp_i(net_scratchpad, "Poll: ", n);
+    s = stp_rom(s, (vehicle_pollcfg.magic == VEHICLE_POLLCFG_MAGIC)
+            ? " entries, custom config" : " entries, default config");
+    }
+  else
+    {
+    k = atoi(arguments);
+    if (k >= n) return FALSE;
+    s = stp_i(net_scratchpad, "Poll ", k);
+    s = stp_x(s, ": ", vehicle_poll_plist[k].moduleid);
+    s = stp_x(s, "/", vehicle_poll_plist[k].pid);
+    s = stp_rom(s, (vehicle_poll_isenabled(k)) ? " on " : " off ");
+    s = stp_i(s, NULL, vehicle_poll_cfgtime(k, 0));
+    s = stp_i(s, "/", vehicle_poll_cfgtime(k, 1));
+    s = stp_i(s, "/", vehicle_poll_cfgtime(k, 2));
+    }
+
+  net_send_sms_start(caller);
+  net_puts_ram(net_scratchpad);
+  return TRUE;
+  }
+#endif //OVMS_POLLER
+
 BOOL net_sms_handle_help(char *caller, char *command, char *arguments);
 
 // This is the SMS command table
@@ -986,6 +1048,9 @@ rom char sms_cmdtable[][NET_SMS_CMDWIDTH] =
     "3CTP",
 #endif //OVMS_NO_CTP
     "3TEMPS",
+#ifdef OVMS_POLLER
+    "2POLL",
+#endif
 #ifdef OVMS_ACCMODULE
     "2ACC ",
 #endif
@@ -1017,19 +1082,19 @@ rom BOOL (*sms_hfntable[])(char *caller, char *command, char *arguments) =
   &net_sms_handle_featuresq,
   &net_sms_handle_feature,
 #ifndef OVMS_NO_HOMELINK
-  &net_sms_handle_homelink,
+  &net_sms_handle_cmd,
 #endif // OVMS_NO_HOMELINK
 #ifndef OVMS_NO_LOCK
-  &net_sms_handle_lock,
-  &net_sms_handle_unlock,
-  &net_sms_handle_valet,
-  &net_sms_handle_unvalet,
+  &net_sms_handle_cmd,
+  &net_sms_handle_cmd,
+  &net_sms_handle_cmd,
+  &net_sms_handle_cmd,
 #endif // OVMS_NO_LOCK
 #ifndef OVMS_NO_CHARGECONTROL
   &net_sms_handle_chargemode,
-  &net_sms_handle_chargestart,
-  &net_sms_handle_chargestop,
-  &net_sms_handle_cooldown,
+  &net_sms_handle_cmd,
+  &net_sms_handle_cmd,
+  &net_sms_handle_cmd,
 #endif // OVMS_NO_CHARGECONTROL
   &net_sms_handle_version,
   &net_sms_handle_reset,
@@ -1037,12 +1102,58 @@ rom BOOL (*sms_hfntable[])(char *caller, char *command, char *arguments) =
   &net_sms_handle_ctp,
 #endif //OVMS_NO_CTP
   &net_sms_handle_temps,
+#ifdef OVMS_POLLER
+  &net_sms_handle_poll,
+#endif
 #ifdef OVMS_ACCMODULE
   &acc_handle_sms,
 #endif
   &net_sms_handle_help
   };
 
+// The third table holds the MSG command code (CMD_*) of each SMS command,
+// 0 if it has none. It is passed to the handler in net_sms_cmdcode,
+// SMS commands with a code and no own handler use net_sms_handle_cmd(),
+// so SMS and MSG share the vehicle module command handler.
+rom unsigned char sms_codetable[] =
+  {
+  0, 0, 0, 0,             // REGISTER?, REGISTER, PASS?, PASS
+  0, CMD_Alert,           // GPS, STAT
+  CMD_QueryParams, 0, 0,  // PARAMS?, PARAMS, AP
+  0, 0, 0, 0,             // MODULE?, MODULE, VEHICLE?, VEHICLE
+  0, 0, 0, 0, 0, 0, 0,    // GPRS?, GPRS, GSMLOCK?, GSMLOCK, SERVER?, SERVER, DIAG
+  CMD_QueryFeatures,      // FEATURES?
+  CMD_SetFeature,         // FEATURE
+#ifndef OVMS_NO_HOMELINK
+  CMD_Homelink,
+#endif // OVMS_NO_HOMELINK
+#ifndef OVMS_NO_LOCK
+  CMD_Lock,
+  CMD_UnLock,
+  CMD_ValetOn,
+  CMD_ValetOff,
+#endif // OVMS_NO_LOCK
+#ifndef OVMS_NO_CHARGECONTROL
+  CMD_SetChargeMode,
+  CMD_StartCharge,
+  CMD_StopCharge,
+  CMD_CoolDown,
+#endif // OVMS_NO_CHARGECONTROL
+  0,                      // VERSION
+  CMD_Reboot,             // RESET
+#ifndef OVMS_NO_CTP
+  0,
+#endif //OVMS_NO_CTP
+  0,                      // TEMPS
+#ifdef OVMS_POLLER
+  CMD_PollConfig,
+#endif
+#ifdef OVMS_ACCMODULE
+  0,
+#endif
+  0                       // HELP
+  };
+
 
 // net_sms_checkauth: check SMS caller & first argument
 //   according to auth mode
@@ -1081,12 +1192,32 @@ BOOL net_sms_checkauth(char authmode, char *caller, char **arguments)
 // It tries to find a matching command handler based on the
 // command tables.
 
+////////////////////////////////////////////////////////////////////////
+// net_sms_findcmd()
+// Find the command in an SMS command table (see sms_cmdtable comment).
+// Entries are checked in table order (left match), the first character
+// is compared before the full string so most entries cost a single read.
+// Returns the table index, or -1 if the command is not in the table.
+//
+signed char net_sms_findcmd(const rom far char *cmdtable, char *command)
+  {
+  signed char k;
+
+  for (k=0; cmdtable[0] != 0; k++, cmdtable += NET_SMS_CMDWIDTH)
+    {
+    if ((cmdtable[1] == command[0]) && (starts_with(command, cmdtable+1)))
+      return k;
+    }
+
+  return -1;
+  }
+
 BOOL net_sms_in(char *caller, char *buf)
   {
   // The buf contains an SMS command
   // and caller contains the caller telephone number
   char *p;
-  UINT8 k;
+  signed char k;
 
   // Convert SMS command (first word) to upper-case
   for (p=buf; ((*p!=0)&&(*p!=' ')); p++)
@@ -1094,31 +1225,30 @@ BOOL net_sms_in(char *caller, char *buf)
   if (*p==' ') p++;
 
   // Command parsing...
-  for (k=0; sms_cmdtable[k][0] != 0; k++)
+  k = net_sms_findcmd((char const rom far*)sms_cmdtable, buf);
+  if (k >= 0)
     {
-    if (memcmppgm2ram(buf, (char const rom far*)sms_cmdtable[k]+1, strlenpgm((char const rom far*)sms_cmdtable[k])-1) == 0)
-      {
-      BOOL result = FALSE;
-      char *arguments = net_sms_initargs(p);
+    BOOL result = FALSE;
+    char *arguments = net_sms_initargs(p);
 
-      if (!net_sms_checkauth(sms_cmdtable[k][0], caller, &arguments))
-          return FALSE; // auth error
+    if (!net_sms_checkauth(sms_cmdtable[k][0], caller, &arguments))
+        return FALSE; // auth error
 
-      if (vehicle_fn_smshandler != NULL)
-        {
-        if (vehicle_fn_smshandler(TRUE, caller, buf, arguments))
-          return TRUE; // handled
-        }
+    if (vehicle_fn_smshandler != NULL)
+      {
+      if (vehicle_fn_smshandler(TRUE, caller, buf, arguments))
+        return TRUE; // handled
+      }
 
-      result = (*sms_hfntable[k])(caller, buf, arguments);
-      if (result)
-        {
-        if (vehicle_fn_smshandler != NULL)
-          vehicle_fn_smshandler(FALSE, caller, buf, arguments);
-        net_send_sms_finish();
-        }
-      return result;
+    net_sms_cmdcode = sms_codetable[k];
+    result = (*sms_hfntable[k])(caller, buf, arguments);
+    if (result)
+      {
+      if (vehicle_fn_smshandler != NULL)
+        vehicle_fn_smshandler(FALSE, caller, buf, arguments);
+      net_send_sms_finish();
       }
+    return result;
     }
 
   if (vehicle_fn_smsextensions != NULL)
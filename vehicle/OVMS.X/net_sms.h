@@ -45,6 +45,7 @@ void net_sms_gps(char* number);
 BOOL net_sms_stat(char* number);
 void net_sms_alert(char *number, alert_type alert);
 BOOL net_sms_checkauth(char authmode, char *caller, char **arguments);
+signed char net_sms_findcmd(const rom far char *cmdtable, char *command);
 BOOL net_sms_in(char *caller, char *buf);
 
 #endif // #ifndef __OVMS_SMS_H
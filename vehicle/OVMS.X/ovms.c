@@ -307,10 +307,17 @@ void main(void)
     {
       CHECKPOINT(0x23)
       net_poll();
+#ifdef OVMS_CANRXQUEUE
+      vehicle_rxq_process();
+#endif
     }
 
     CHECKPOINT(0x24)
     net_idlepoll();
+#ifdef OVMS_CANRXQUEUE
+    CHECKPOINT(0x2C)
+    vehicle_rxq_process();
+#endif
     vehicle_idlepoll();
 
     ClrWdt(); // Clear Watchdog Timer
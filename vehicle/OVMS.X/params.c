@@ -46,9 +46,31 @@ rom char EEparam[PARAM_MAX][PARAM_MAX_LENGTH]
 
 #pragma udata
 char par_value[PARAM_MAX_LENGTH];
+unsigned char par_notifies = 0;     // PARAM_NOTIFIES cache (PAR_NOTIFY_*)
+unsigned int par_eewrites = 0;      // EEPROM bytes written since boot (wear counter)
+
+// Update the RAM cache from par_value if param is cached:
+void par_cache(unsigned char param)
+  {
+  if (param == PARAM_NOTIFIES)
+    {
+    par_notifies = 0;
+    if (strstrrampgm(par_value, (char const rom far*)"SMS") != NULL)
+      par_notifies |= PAR_NOTIFY_SMS;
+    if (strstrrampgm(par_value, (char const rom far*)"IP") != NULL)
+      par_notifies |= PAR_NOTIFY_IP;
+    }
+  else if (param == PARAM_MILESKM)
+    {
+    // also set by SMS/MSG without vehicle_initialise():
+    can_mileskm = par_value[0];
+    }
+  }
 
 void par_initialise(void)
   {
+  par_get(PARAM_NOTIFIES);
+  par_cache(PARAM_NOTIFIES);
   }
 
 void par_read(unsigned char param)
@@ -80,7 +102,10 @@ void par_write(unsigned char param)
   if ((param <= PARAM_MODULEPASS) && (par_value[0] == 0))
       return;
   
+  par_cache(param);
+
   // Write parameter to EEprom
+  // (only changed bytes: an EEprom byte write takes 4 ms and wears the cell)
   eeaddress = (int)param;
   eeaddress = eeaddress*PARAM_MAX_LENGTH;
   EEADRH = eeaddress >> 8;
@@ -88,6 +113,10 @@ void par_write(unsigned char param)
     {
     EEADR = (unsigned char)&EEparam[param][k]; // get low byte of address
     EECON1 = 0; //ensure CFGS=0 and EEPGD=0
+    EECON1bits.RD = 1; // read current value
+    if (EEDATA == par_value[k])
+      continue;
+    par_eewrites++;
     EECON1bits.WREN = 1; //enable write to EEPROM
     EEDATA = par_value[k]; // and data
     savint = INTCON; // Save interrupts state
@@ -60,6 +60,9 @@
 #define PARAM_ACC_3       0x12
 #define PARAM_ACC_4       0x13
 
+#define PARAM_POLLCFG     0x10 // OVMS_POLLER: poll list config (binary, 2 slots, replaces ACC)
+                               // (also used by the Twizy CFG profiles, see vehicle_twizy.c)
+
 #define PARAM_GPRSDNS     0x16
 #define PARAM_TIMEZONE    0x17
 
@@ -74,7 +77,14 @@
 #define PARAM_FEATURE14   0x1E
 #define PARAM_FEATURE15   0x1F
 
+// RAM cache of parameters used in frequently called code,
+// updated by par_write() (PARAM_MILESKM: can_mileskm, see vehicle.h):
+#define PAR_NOTIFY_SMS    0x01      // PARAM_NOTIFIES contains "SMS"
+#define PAR_NOTIFY_IP     0x02      // PARAM_NOTIFIES contains "IP"
+
 extern char par_value[PARAM_MAX_LENGTH];
+extern unsigned char par_notifies;  // PARAM_NOTIFIES cache (PAR_NOTIFY_*)
+extern unsigned int par_eewrites;   // EEPROM bytes written since boot (wear counter)
 
 void par_initialise(void);
 void par_read(unsigned char param);
@@ -313,29 +313,46 @@ long gps2latlon(char *gpscoord)
 }
 
 
+// CRC-16 (polynomial 0xA001 reflected) nibble table:
+rom WORD crc16_tab[16] =
+  {
+  0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+  0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+  };
+
+// Add one byte to a running 16bit CRC (start with 0xffff)
+WORD crc16_add(WORD crc, BYTE b)
+  {
+  crc = (crc >> 4) ^ crc16_tab[(crc ^ b) & 0x0f];
+  crc = (crc >> 4) ^ crc16_tab[(crc ^ (b >> 4)) & 0x0f];
+  return crc;
+  }
+
 // Calculate a 16bit CRC and return it
 WORD crc16(char *data, int length)
   {
   WORD crc = 0xffff;
-  int k;
 
   while (length>0)
     {
-    crc ^= (BYTE)*data++;
+    crc = crc16_add(crc, (BYTE)*data++);
     length--;
-
-    for (k = 0; k < 8; ++k)
-      {
-      if (crc & 1)
-        crc = (crc >> 1) ^ 0xA001;
-      else
-        crc = (crc >> 1);
-      }
     }
 
   return crc;
 }
 
+// Calculate a 16bit CRC of a string (same as crc16(s, strlen(s)))
+WORD crc16_str(char *s)
+  {
+  WORD crc = 0xffff;
+
+  while (*s)
+    crc = crc16_add(crc, (BYTE)*s++);
+
+  return crc;
+  }
+
 ////////////////////////////////////////////////////////////////////////
 // convert GSM clock response string to timestamp
 // timezone string must be set correctly to convert local time to UTC
@@ -453,6 +470,23 @@ char *nextarg(char *lastarg)
   return lastarg;
 }
 
+// restarg -- retrieve the rest of the arguments (not tokenized)
+
+char *restarg(char *lastarg)
+{
+  char *p;
+
+  if (lastarg == NULL)
+    return NULL;
+
+  // skip last argument:
+  for (p=lastarg; *p; p++) {}
+  if (p == args_end)
+    return NULL;
+
+  return ++p;
+}
+
 
 // string-print rom string:
 
@@ -61,6 +61,8 @@ float myatof(char *s);             // builtin atof() does not work
 unsigned long axtoul(char *s);     // hex string decode
 long gps2latlon(char *gpscoord);   // convert GPS coordinate to latlon value
 WORD crc16(char *data, int length);  // Calculate a 16bit CRC and return it
+WORD crc16_add(WORD crc, BYTE b);    // Add a byte to a running 16bit CRC
+WORD crc16_str(char *s);             // Calculate the 16bit CRC of a string
 unsigned long datestring_to_timestamp(const char *arg); // convert GSM clock response string to timestamp
 void cr2lf(char *s);                // replace \r by \n in s (to convert msg text to sms)
 void ltox(unsigned long i, char *s, unsigned int len); // format hexadecimal numbers
@@ -80,6 +82,7 @@ BOOL starts_with(char *s, const rom char *pfx);
 // argument tokenizer:
 char *firstarg(char *arguments, char delimiter);
 char *nextarg(char *lastarg);
+char *restarg(char *lastarg);
 
 // sprintf replacement utils: stp string print
 char *stp_rom(char *dst, const rom char *val);
@@ -80,18 +80,437 @@ unsigned char vehicle_poll_busactive;    // Indicates recent activity on the pas
 unsigned int vehicle_poll_ml_remain;     // Bytes remaining for vehicle poll
 unsigned int vehicle_poll_ml_offset;     // Offset of vehicle poll data
 unsigned int vehicle_poll_ml_frame;      // Frame number for vehicle poll
+unsigned char vehicle_poll_ml_seq;       // Next expected consecutive frame sequence no.
+unsigned char vehicle_poll_ml_bscnt;     // Consecutive frames left in current block
+unsigned char vehicle_poll_ml_timer;     // Multi frame timeout countdown
+unsigned int vehicle_poll_ml_errors;     // Multi frame sequence errors
+unsigned int vehicle_poll_ml_timeouts;   // Multi frame reception timeouts
+unsigned char vehicle_poll_stmin;        // Flow control STmin for current poll
+unsigned char vehicle_poll_bs;           // Flow control block size for current poll
+unsigned char *vehicle_poll_rxbuf;       // Reassembly buffer of current poll
+unsigned char vehicle_poll_rxbufsize;    // Size of reassembly buffer
 
 rom BOOL (*vehicle_fn_pollpid)(void);
 
+#pragma udata VEHICLE_POLL
+unsigned int vehicle_poll_due[VEHICLE_POLL_MAXPIDS]; // Next due time per entry
+unsigned char vehicle_poll_nextidx;      // Entry with earliest due time (0xff = none)
+unsigned char vehicle_poll_latemax[VEHICLE_POLL_NSTATES]; // Max scheduling delay
+unsigned int vehicle_poll_latesum[VEHICLE_POLL_NSTATES];  // Sum of scheduling delays
+unsigned int vehicle_poll_latecnt[VEHICLE_POLL_NSTATES];  // Number of requests sent
+vehicle_pollstat_t vehicle_poll_stats[VEHICLE_POLL_MAXPIDS]; // Statistics per entry
+unsigned char vehicle_poll_batchidx[VEHICLE_POLL_MAXBATCH]; // Entries of current request
+unsigned char vehicle_poll_batchcnt;     // Number of entries in current request
+unsigned char vehicle_poll_dxpos;        // Batch demux: bytes collected for current DID
+unsigned char vehicle_poll_dxlen;        // Batch demux: DID + data length (0 = abort)
+unsigned char vehicle_poll_dxbuf[8];     // Batch demux: single frame response for DID
+unsigned char vehicle_poll_waiting;      // Response timeout countdown (1/10 s)
+unsigned int vehicle_poll_reqtime;       // TMR0 time of current request
+
+#pragma udata VEHICLE_POLLCFG
+vehicle_pollcfg_t vehicle_pollcfg;       // Poll list configuration (EEPROM copy)
+
+#pragma udata VEHICLE
 #endif //#ifdef OVMS_POLLER
 
+#ifdef OVMS_CANRXQUEUE
+unsigned char vehicle_rxq_head;          // Next slot to be filled by ISR
+unsigned char vehicle_rxq_tail;          // Next slot to be processed
+unsigned char vehicle_rxq_maxdepth;      // Queue high water mark
+unsigned int vehicle_rxq_dropped[2];     // Frames lost due to full queue (per RXB)
+
+#pragma udata VEHICLE_RXQ
+vehicle_rxq_frame_t vehicle_rxq[VEHICLE_RXQ_SIZE];
+#pragma udata VEHICLE
+#endif //#ifdef OVMS_CANRXQUEUE
+
+#if defined(OVMS_CANRXQUEUE) || defined(OVMS_CANSTATS)
+unsigned int vehicle_can_overflow[2];    // Hardware RXBnOVFL counts (per RXB)
+#endif
+
+#ifdef OVMS_CANTXQUEUE
+typedef struct
+{
+  unsigned int id;
+  unsigned char prio;
+  unsigned char len;
+  unsigned char data[8];
+} vehicle_txq_frame_t;
+
+unsigned char vehicle_txq_first;         // First queued frame
+unsigned char vehicle_txq_cnt;           // Number of queued frames
+unsigned char vehicle_txq_highcnt;       // ...of these high priority (at the front)
+unsigned char vehicle_txq_maxdepth;      // Queue high water mark
+unsigned int vehicle_txq_dropped;        // Frames lost due to full queue
+unsigned int vehicle_txq_errors;         // TX errors / aborts detected
+
+#pragma udata VEHICLE_TXQ
+vehicle_txq_frame_t vehicle_txq[VEHICLE_TXQ_SIZE];
+#endif //#ifdef OVMS_CANTXQUEUE
+
+#ifdef OVMS_CANSTATS
+#pragma udata VEHICLE_CANSTAT
+vehicle_canstat_t vehicle_canstat[VEHICLE_CANSTAT_SIZE]; // Top talkers
+unsigned long vehicle_canstat_frames[2]; // Frames per RX buffer
+unsigned int vehicle_canstat_secframes;  // Frames in current second
+unsigned int vehicle_canstat_secbytes;   // Data bytes in current second
+unsigned int vehicle_canstat_secs;       // Seconds since reset
+unsigned int vehicle_canstat_kbps;       // Bit rate (from BRGCON)
+unsigned int vehicle_canstat_fps;        // Frames/sec last second
+unsigned int vehicle_canstat_fpsmax;     // Frames/sec max
+unsigned char vehicle_canstat_load;      // Bus load % last second
+unsigned char vehicle_canstat_loadavg;   // Bus load % moving average
+unsigned char vehicle_canstat_loadmax;   // Bus load % max
+#endif //#ifdef OVMS_CANSTATS
+
+#ifdef OVMS_CANCACHE
+#pragma udata VEHICLE_CANCACHE
+vehicle_cancache_t vehicle_cancache[VEHICLE_CANCACHE_SIZE];
+rom unsigned int *vehicle_cancache_ids;         // 0 terminated ID list
+unsigned int vehicle_cancache_checks;           // Frames checked
+unsigned int vehicle_cancache_hits;             // Frames skipped (unchanged)
+#endif //#ifdef OVMS_CANCACHE
+
 #pragma udata
 
 #ifdef OVMS_POLLER
 
+////////////////////////////////////////////////////////////////////////
+// Poll scheduler:
+// Each poll list entry has a due time (vehicle_poll_ticker seconds).
+// vehicle_poll_nextidx points to the entry due first, so the once per
+// second poller call is O(1) unless a request needs to be sent. After
+// sending, the entry is rescheduled at due+polltime, keeping the period
+// stable. Entries start with phase offsets to avoid all entries falling
+// due in the same second.
+//
+
+// TRUE if time t has been reached (wrap safe):
+#define VEHICLE_POLL_ISDUE(t) ((int)(vehicle_poll_ticker - (t)) >= 0)
+
+// Number of poll list entries handled:
+unsigned char vehicle_poll_count(void)
+  {
+  rom vehicle_pid_t *p;
+  unsigned char i;
+
+  if (vehicle_poll_plist == NULL)
+    return 0;
+  for (p=vehicle_poll_plist, i=0; (p->moduleid != 0)&&(i < VEHICLE_POLL_MAXPIDS); p++, i++) ;
+  return i;
+  }
+
+// Entry idx enabled by config?
+BOOL vehicle_poll_isenabled(unsigned char idx)
+  {
+  return ((vehicle_pollcfg.magic != VEHICLE_POLLCFG_MAGIC)||(idx >= VEHICLE_POLLCFG_MAX)||
+          ((vehicle_pollcfg.entry[idx].flags & VEHICLE_POLLCFG_OFF) == 0));
+  }
+
+// Configured poll period of entry idx in state (ignoring enable state):
+unsigned int vehicle_poll_cfgtime(unsigned char idx, unsigned char state)
+  {
+  if ((vehicle_pollcfg.magic == VEHICLE_POLLCFG_MAGIC)&&(idx < VEHICLE_POLLCFG_MAX)&&
+      (vehicle_pollcfg.entry[idx].polltime[state] != VEHICLE_POLLCFG_DEFAULT))
+    return vehicle_pollcfg.entry[idx].polltime[state];
+  return vehicle_poll_plist[idx].polltime[state];
+  }
+
+// Effective poll period of entry idx in state (0 = off):
+unsigned int vehicle_poll_gettime(unsigned char idx, unsigned char state)
+  {
+  if (!vehicle_poll_isenabled(idx))
+    return 0;
+  return vehicle_poll_cfgtime(idx, state);
+  }
+
+void vehicle_poll_findnext(void)
+  {
+  rom vehicle_pid_t *p;
+  unsigned char i;
+
+  vehicle_poll_nextidx = 0xff;
+  if (vehicle_poll_plist == NULL)
+    return;
+
+  for (p=vehicle_poll_plist, i=0; (p->moduleid != 0)&&(i < VEHICLE_POLL_MAXPIDS); p++, i++)
+    {
+    if (vehicle_poll_gettime(i, vehicle_poll_state) == 0)
+      continue;
+    if ((vehicle_poll_nextidx == 0xff) ||
+        ((int)(vehicle_poll_due[i] - vehicle_poll_due[vehicle_poll_nextidx]) < 0))
+      vehicle_poll_nextidx = i;
+    }
+  }
+
+void vehicle_poll_schedule(void)
+  {
+  rom vehicle_pid_t *p;
+  unsigned char i;
+  unsigned int t;
+
+  vehicle_poll_plcur = NULL;
+  if (vehicle_poll_plist != NULL)
+    {
+    for (p=vehicle_poll_plist, i=0; (p->moduleid != 0)&&(i < VEHICLE_POLL_MAXPIDS); p++, i++)
+      {
+      t = vehicle_poll_gettime(i, vehicle_poll_state);
+      // spread phases: entry i starts at offset i modulo its period
+      vehicle_poll_due[i] = vehicle_poll_ticker + ((t > 0) ? (i % t) : 0);
+      }
+    }
+  vehicle_poll_findnext();
+  }
+
+// Poll list checksum, binds the config to the list:
+unsigned int vehicle_poll_listsum(void)
+  {
+  rom vehicle_pid_t *p;
+  unsigned char i;
+  unsigned int sum = 0;
+
+  for (p=vehicle_poll_plist, i=vehicle_poll_count(); i > 0; p++, i--)
+    sum = ((sum << 1) | (sum >> 15)) ^ p->moduleid ^ p->pid ^ p->type;
+  return sum;
+  }
+
+// Clear config: all entries enabled with list defaults, magic unset:
+void vehicle_poll_initcfg(void)
+  {
+  unsigned char k;
+
+  memset((void*)&vehicle_pollcfg, VEHICLE_POLLCFG_DEFAULT, sizeof(vehicle_pollcfg));
+  vehicle_pollcfg.magic = 0;
+  for (k=0; k<VEHICLE_POLLCFG_MAX; k++)
+    vehicle_pollcfg.entry[k].flags = 0;
+  }
+
+void vehicle_poll_loadcfg(void)
+  {
+  par_getbin(PARAM_POLLCFG, &vehicle_pollcfg, sizeof(vehicle_pollcfg));
+  if ((vehicle_pollcfg.magic != VEHICLE_POLLCFG_MAGIC)||
+      (vehicle_pollcfg.count != vehicle_poll_count())||
+      (vehicle_pollcfg.listsum != vehicle_poll_listsum()))
+    {
+    // no config for this poll list:
+    vehicle_poll_initcfg();
+    }
+  }
+
+// Set config for entry idx (polltime NULL = list defaults), save & apply:
+void vehicle_poll_setcfg(unsigned char idx, unsigned char flags, unsigned char *polltime)
+  {
+  unsigned char k;
+
+  if ((idx >= VEHICLE_POLLCFG_MAX)||(idx >= vehicle_poll_count()))
+    return;
+
+  if (vehicle_pollcfg.magic != VEHICLE_POLLCFG_MAGIC)
+    vehicle_poll_initcfg(); // first entry set: other entries keep defaults
+
+  vehicle_pollcfg.magic = VEHICLE_POLLCFG_MAGIC;
+  vehicle_pollcfg.count = vehicle_poll_count();
+  vehicle_pollcfg.listsum = vehicle_poll_listsum();
+  vehicle_pollcfg.entry[idx].flags = flags;
+  for (k=0; k<VEHICLE_POLL_NSTATES; k++)
+    vehicle_pollcfg.entry[idx].polltime[k] = (polltime) ? polltime[k] : VEHICLE_POLLCFG_DEFAULT;
+
+  par_setbin(PARAM_POLLCFG, &vehicle_pollcfg, sizeof(vehicle_pollcfg));
+  vehicle_poll_schedule();
+  }
+
+// Clear config, return to list defaults:
+void vehicle_poll_resetcfg(void)
+  {
+  vehicle_poll_initcfg();
+  par_setbin(PARAM_POLLCFG, &vehicle_pollcfg, sizeof(vehicle_pollcfg));
+  vehicle_poll_schedule();
+  }
+
+// Poll config command (SMS / MSG), arguments:
+//    <idx> <enable> [<time0> <time1> <time2>]  -- set entry
+//        (times omitted or < 0 = poll list default, max 254)
+//    -1  -- reset all entries to poll list defaults
+//  arg = first argument token (see firstarg / nextarg)
+//  returns 0 = ok, 1 = syntax error, 2 = range error
+unsigned char vehicle_poll_cfgcmd(char *arg)
+  {
+  unsigned char idx, flags, k;
+  unsigned char t[VEHICLE_POLL_NSTATES];
+  int v;
+
+  if ((arg == NULL)||(*arg == 0))
+    return 1;
+  if (arg[0] == '-')
+    {
+    vehicle_poll_resetcfg();
+    return 0;
+    }
+
+  v = atoi(arg);
+  if ((v < 0)||(v >= VEHICLE_POLLCFG_MAX)||(v >= vehicle_poll_count()))
+    return 2;
+  idx = v;
+
+  if ((arg = nextarg(arg)) == NULL)
+    return 1;
+  flags = (atoi(arg)) ? 0 : VEHICLE_POLLCFG_OFF;
+
+  if ((arg = nextarg(arg)) == NULL)
+    {
+    vehicle_poll_setcfg(idx, flags, NULL);
+    return 0;
+    }
+  for (k=0; k<VEHICLE_POLL_NSTATES; k++)
+    {
+    if (arg == NULL)
+      return 1;
+    v = atoi(arg);
+    if ((*arg == 0)||(v < 0))
+      t[k] = VEHICLE_POLLCFG_DEFAULT;
+    else if (v < VEHICLE_POLLCFG_DEFAULT)
+      t[k] = v;
+    else
+      return 2;
+    arg = nextarg(arg);
+    }
+  vehicle_poll_setcfg(idx, flags, t);
+  return 0;
+  }
+
 void vehicle_poll_setpidlist(rom vehicle_pid_t *plist)
   {
   vehicle_poll_plist = plist;
+  vehicle_poll_waiting = 0;
+  vehicle_poll_batchcnt = 0;
+  memset((void*)vehicle_poll_stats, 0, sizeof(vehicle_poll_stats));
+  vehicle_poll_loadcfg();
+  vehicle_poll_schedule();
+  }
+
+// Read TMR0 (51.2 us ticks, reset by the main loop at ~0x4c00):
+unsigned int vehicle_poll_tmr0(void)
+  {
+  unsigned int t;
+  t = TMR0L; // latches TMR0H
+  t += ((unsigned int) TMR0H) << 8;
+  return t;
+  }
+
+// Response to current request received:
+// (called by vehicle_poll_poll0(), see below)
+#ifndef OVMS_CANRXQUEUE
+#pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
+void vehicle_poll_response(void)
+  {
+  vehicle_pollstat_t *st;
+  unsigned char k;
+  unsigned int t;
+
+  if (vehicle_poll_waiting == 0)
+    return; // late or repeated response
+  vehicle_poll_waiting = 0;
+
+  t = TMR0L; // latches TMR0H (see vehicle_poll_tmr0)
+  t += ((unsigned int) TMR0H) << 8;
+  if (t >= vehicle_poll_reqtime)
+    t -= vehicle_poll_reqtime;
+  else
+    t += 0x4c00 - vehicle_poll_reqtime;
+  t /= 20; // ~ms
+  if (t > 255) t = 255;
+
+  for (k=0; k<vehicle_poll_batchcnt; k++)
+    {
+    st = &vehicle_poll_stats[vehicle_poll_batchidx[k]];
+    if ((st->resp == 0)||(t < st->latmin)) st->latmin = t;
+    if (t > st->latmax) st->latmax = t;
+    if (st->resp == 0)
+      st->latavg = t;
+    else
+      st->latavg = (((unsigned int)st->latavg * 7) + t) >> 3;
+    if (st->resp < 0xffff) st->resp++;
+    st->failcnt = 0;
+    }
+  }
+#ifndef OVMS_CANRXQUEUE
+#pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
+
+// Response timer tick (expire = FALSE) or current request not answered
+// in time (expire = TRUE). The request is taken over with interrupts
+// disabled, as the ISR may complete it; once vehicle_poll_waiting is 0
+// the ISR leaves the stats alone, so these are updated and the next
+// poll is searched with interrupts enabled.
+void vehicle_poll_timeout(BOOL expire)
+  {
+  vehicle_pollstat_t *st;
+  unsigned char idx[VEHICLE_POLL_MAXBATCH];
+  unsigned char cnt, k;
+
+  cnt = 0;
+  INTCONbits.GIEH = 0;
+  if ((vehicle_poll_waiting > 0)&&((expire)||(--vehicle_poll_waiting == 0)))
+    {
+    vehicle_poll_waiting = 0;
+    cnt = vehicle_poll_batchcnt;
+    for (k=0; k<cnt; k++)
+      idx[k] = vehicle_poll_batchidx[k];
+    }
+  INTCONbits.GIEH = 1;
+
+  if (cnt == 0)
+    return;
+  for (k=0; k<cnt; k++)
+    {
+    st = &vehicle_poll_stats[idx[k]];
+    if (st->timeouts < 255) st->timeouts++;
+    if (st->failcnt < 255) st->failcnt++;
+    if (st->failcnt <= VEHICLE_POLL_RETRIES)
+      {
+      // retry on next poller call:
+      vehicle_poll_due[idx[k]] = vehicle_poll_ticker;
+      }
+    }
+  vehicle_poll_findnext();
+  }
+
+// Add DIDs for the same module due within half their period
+// to the current 0x22 request (see vehicle_pid_t.rlen):
+void vehicle_poll_batch(unsigned char *msg)
+  {
+  rom vehicle_pid_t *p;
+  unsigned char i;
+  unsigned int t;
+
+  for (p=vehicle_poll_plist, i=0;
+       (p->moduleid != 0)&&(i < VEHICLE_POLL_MAXPIDS)&&(vehicle_poll_batchcnt < VEHICLE_POLL_MAXBATCH);
+       p++, i++)
+    {
+    if ((p == vehicle_poll_plcur)||(p->type != VEHICLE_POLL_TYPE_OBDIIEXTENDED)||
+        (p->moduleid != vehicle_poll_plcur->moduleid)||
+        (p->rmoduleid != vehicle_poll_plcur->rmoduleid)||
+        (p->rlen == 0)||(p->rlen > VEHICLE_POLL_MAXRLEN))
+      continue;
+    t = vehicle_poll_gettime(i, vehicle_poll_state);
+    if ((t == 0)||(vehicle_poll_stats[i].failcnt > VEHICLE_POLL_RETRIES))
+      continue; // not polled in this state / backing off
+    if (!VEHICLE_POLL_ISDUE(vehicle_poll_due[i] - (t >> 1)))
+      continue;
+
+    msg[msg[0]+1] = p->pid >> 8;
+    msg[msg[0]+2] = p->pid & 0xff;
+    msg[0] += 2;
+    vehicle_poll_batchidx[vehicle_poll_batchcnt++] = i;
+
+    vehicle_poll_due[i] += t;
+    if (VEHICLE_POLL_ISDUE(vehicle_poll_due[i]))
+      vehicle_poll_due[i] = vehicle_poll_ticker + t;
+    }
+
+  if (vehicle_poll_batchcnt > 1)
+    vehicle_poll_findnext();
   }
 
 void vehicle_poll_setstate(unsigned char state)
@@ -99,104 +518,272 @@ void vehicle_poll_setstate(unsigned char state)
   if ((state >= 0)&&(state < VEHICLE_POLL_NSTATES)&&(state != vehicle_poll_state))
     {
     vehicle_poll_state = state;
-    vehicle_poll_ticker = 0;
-    vehicle_poll_plcur = NULL;
+    vehicle_poll_schedule();
     }
   }
 
 void vehicle_poll_poller(void)
   {
-  if (vehicle_poll_plcur == NULL)
-    {
-    vehicle_poll_plcur = vehicle_poll_plist;
-    }
+  unsigned char i, k;
+  unsigned int t, late;
+  unsigned char msg[8];
 
-  while (vehicle_poll_plcur->moduleid != 0)
+  // Previous request still unanswered?
+  if (vehicle_poll_waiting > 0)
+    vehicle_poll_timeout(TRUE);
+
+  i = vehicle_poll_nextidx;
+  if ((i != 0xff)&&(VEHICLE_POLL_ISDUE(vehicle_poll_due[i])))
     {
-    if ((vehicle_poll_plcur->polltime[vehicle_poll_state] > 0)&&
-        ((vehicle_poll_ticker % vehicle_poll_plcur->polltime[vehicle_poll_state] ) == 0))
+    // We need to poll this one...
+    vehicle_poll_plcur = vehicle_poll_plist + i;
+
+    // Scheduling statistics:
+    late = vehicle_poll_ticker - vehicle_poll_due[i];
+    if (late > 255) late = 255;
+    if (late > vehicle_poll_latemax[vehicle_poll_state])
+      vehicle_poll_latemax[vehicle_poll_state] = late;
+    if (vehicle_poll_latesum[vehicle_poll_state] > 0xff00)
       {
-      // We need to poll this one...
-      
-      while ((TXB0CON & 0b00111000) == 0b00001000) {} // wait for TX done / error
-      TXB0CON = 0; // init new TX / abort TX error
-      while (TXB0CONbits.TXREQ) {} // wait for TX clear
-      
-      vehicle_poll_type = vehicle_poll_plcur->type;
-      vehicle_poll_pid = vehicle_poll_plcur->pid;
-      if (vehicle_poll_plcur->rmoduleid != 0)
-        {
-        // send to <moduleid>, listen to response from <rmoduleid>:
-        vehicle_poll_moduleid_send = vehicle_poll_plcur->moduleid;
-        vehicle_poll_moduleid_low = vehicle_poll_plcur->rmoduleid;
-        vehicle_poll_moduleid_high = vehicle_poll_plcur->rmoduleid;
-        }
-      else
+      vehicle_poll_latesum[vehicle_poll_state] >>= 1;
+      vehicle_poll_latecnt[vehicle_poll_state] >>= 1;
+      }
+    vehicle_poll_latesum[vehicle_poll_state] += late;
+    vehicle_poll_latecnt[vehicle_poll_state]++;
+
+    // Reschedule, skip missed periods, back off if ECU doesn't answer:
+    t = vehicle_poll_gettime(i, vehicle_poll_state);
+    k = vehicle_poll_stats[i].failcnt;
+    if (k > VEHICLE_POLL_RETRIES)
+      {
+      k -= VEHICLE_POLL_RETRIES;
+      t <<= (k < VEHICLE_POLL_MAXBACKOFF) ? k : VEHICLE_POLL_MAXBACKOFF;
+      }
+    vehicle_poll_due[i] += t;
+    if (VEHICLE_POLL_ISDUE(vehicle_poll_due[i]))
+      vehicle_poll_due[i] = vehicle_poll_ticker + t;
+    vehicle_poll_findnext();
+
+    vehicle_poll_type = vehicle_poll_plcur->type;
+    vehicle_poll_pid = vehicle_poll_plcur->pid;
+    vehicle_poll_stmin = (vehicle_poll_plcur->stmin)
+            ? vehicle_poll_plcur->stmin : VEHICLE_POLL_STMIN_DEFAULT;
+    vehicle_poll_bs = vehicle_poll_plcur->bs;
+    vehicle_poll_rxbuf = vehicle_poll_plcur->rxbuf;
+    vehicle_poll_rxbufsize = vehicle_poll_plcur->rxsize;
+    if (vehicle_poll_plcur->rmoduleid != 0)
+      {
+      // send to <moduleid>, listen to response from <rmoduleid>:
+      vehicle_poll_moduleid_send = vehicle_poll_plcur->moduleid;
+      vehicle_poll_moduleid_low = vehicle_poll_plcur->rmoduleid;
+      vehicle_poll_moduleid_high = vehicle_poll_plcur->rmoduleid;
+      }
+    else
+      {
+      // broadcast: send to 0x7df, listen to all responses:
+      vehicle_poll_moduleid_send = 0x7df;
+      vehicle_poll_moduleid_low = 0x7e8;
+      vehicle_poll_moduleid_high = 0x7ef;
+      }
+    
+    vehicle_poll_batchidx[0] = i;
+    vehicle_poll_batchcnt = 1;
+    memset(msg, 0, 8);
+    switch (vehicle_poll_plcur->type)
+      {
+      case VEHICLE_POLL_TYPE_OBDIICURRENT:
+      case VEHICLE_POLL_TYPE_OBDIIFREEZE:
+      case VEHICLE_POLL_TYPE_OBDIISESSION:
+        // 8 bit PID request for single frame response:
+        msg[0] = 0x02;
+        msg[1] = vehicle_poll_type;
+        msg[2] = vehicle_poll_pid;
+        break;
+      case VEHICLE_POLL_TYPE_OBDIIVEHICLE:
+      case VEHICLE_POLL_TYPE_OBDIIGROUP:
+        // 8 bit PID request for multi frame response:
+        vehicle_poll_ml_remain = 0;
+        msg[0] = 0x02;
+        msg[1] = vehicle_poll_type;
+        msg[2] = vehicle_poll_pid;
+        break;
+      case VEHICLE_POLL_TYPE_OBDIIEXTENDED:
+        // 16 bit PID request:
+        vehicle_poll_ml_remain = 0;
+        msg[0] = 0x03;
+        msg[1] = VEHICLE_POLL_TYPE_OBDIIEXTENDED;    // Get extended PID
+        msg[2] = vehicle_poll_pid >> 8;
+        msg[3] = vehicle_poll_pid & 0xff;
+        if ((vehicle_poll_plcur->rmoduleid != 0)&&
+            (vehicle_poll_plcur->rlen > 0)&&(vehicle_poll_plcur->rlen <= VEHICLE_POLL_MAXRLEN))
+          vehicle_poll_batch(msg);
+        break;
+      default:
+        msg[0] = 0; // unknown type: don't send
+        break;
+      }
+    if (msg[0] != 0)
+      {
+      for (k=0; k<vehicle_poll_batchcnt; k++)
         {
-        // broadcast: send to 0x7df, listen to all responses:
-        vehicle_poll_moduleid_send = 0x7df;
-        vehicle_poll_moduleid_low = 0x7e8;
-        vehicle_poll_moduleid_high = 0x7ef;
+        if (vehicle_poll_stats[vehicle_poll_batchidx[k]].req < 0xffff)
+          vehicle_poll_stats[vehicle_poll_batchidx[k]].req++;
         }
-      TXB0SIDL = (vehicle_poll_moduleid_send & 0x07) << 5;
-      TXB0SIDH = (vehicle_poll_moduleid_send >> 3);
-      
-      switch (vehicle_poll_plcur->type)
+      vehicle_poll_reqtime = vehicle_poll_tmr0();
+      vehicle_poll_waiting = VEHICLE_POLL_TIMEOUT;
+      vehicle_can_tx(vehicle_poll_moduleid_send, VEHICLE_TXPRI_NORMAL, 8, msg);
+      }
+    }
+
+  vehicle_poll_ticker++;
+  }
+
+// Poll response handling
+// (called by high_isr unless OVMS_CANRXQUEUE is defined)
+#ifndef OVMS_CANRXQUEUE
+#pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
+
+// Send ISO-TP flow control frame for current poll:
+void vehicle_poll_sendfc(void)
+  {
+  unsigned char msg[8];
+
+  memset(msg, 0, 8);
+  msg[0] = 0x30; // flow control frame type: continue to send
+  msg[1] = vehicle_poll_bs; // block size (0 = send all frames)
+  msg[2] = vehicle_poll_stmin; // separation time
+  vehicle_poll_ml_bscnt = vehicle_poll_bs;
+  if (vehicle_poll_moduleid_send == 0x7df)
+    {
+    // broadcast request: derive module ID from response ID:
+    // (Note: this only works for the SAE standard ID scheme)
+    vehicle_can_tx(can_id-8, VEHICLE_TXPRI_HIGH, 8, msg);
+    }
+  else
+    {
+    // use known module ID:
+    vehicle_can_tx(vehicle_poll_moduleid_send, VEHICLE_TXPRI_HIGH, 8, msg);
+    }
+  }
+
+// Copy multi frame data into the reassembly buffer,
+// returns TRUE when the response is complete:
+BOOL vehicle_poll_rxstore(void)
+  {
+  unsigned int pos;
+  unsigned char k;
+
+  pos = vehicle_poll_ml_offset - can_datalength;
+  for (k=0; (k < can_datalength)&&(pos < vehicle_poll_rxbufsize); k++, pos++)
+    vehicle_poll_rxbuf[pos] = can_databuffer[k];
+
+  if (vehicle_poll_ml_remain > 0)
+    return FALSE; // wait for more
+  can_datalength = 0;
+  return TRUE; // Call vehicle poller
+  }
+
+// Split batched 0x22 response data into DIDs, pass each DID on to the
+// vehicle handler as the single frame response "len 62 DH DL data...":
+void vehicle_poll_demux(unsigned char *data, unsigned char len)
+  {
+  rom vehicle_pid_t *p;
+  unsigned char k;
+  unsigned int did;
+
+  for (; (len > 0)&&(vehicle_poll_dxlen > 0); len--, data++)
+    {
+    vehicle_poll_dxbuf[2 + vehicle_poll_dxpos++] = *data;
+    did = (((unsigned int) vehicle_poll_dxbuf[2]) << 8) + vehicle_poll_dxbuf[3];
+    if (vehicle_poll_dxpos == 2)
+      {
+      // DID complete, get data length:
+      vehicle_poll_dxlen = 0;
+      for (k=0; k<vehicle_poll_batchcnt; k++)
         {
-        case VEHICLE_POLL_TYPE_OBDIICURRENT:
-        case VEHICLE_POLL_TYPE_OBDIIFREEZE:
-        case VEHICLE_POLL_TYPE_OBDIISESSION:
-          // 8 bit PID request for single frame response:
-          TXB0D0 = 0x02;
-          TXB0D1 = vehicle_poll_type;
-          TXB0D2 = vehicle_poll_pid;
-          TXB0D3 = 0x00;
-          TXB0D4 = 0x00;
-          TXB0D5 = 0x00;
-          TXB0D6 = 0x00;
-          TXB0D7 = 0x00;
-          TXB0DLC = 0b00001000; // data length (8)
-          TXB0CON = 0b00001000; // mark for transmission
-          break;
-        case VEHICLE_POLL_TYPE_OBDIIVEHICLE:
-        case VEHICLE_POLL_TYPE_OBDIIGROUP:
-          // 8 bit PID request for multi frame response:
-          vehicle_poll_ml_remain = 0;
-          TXB0D0 = 0x02;
-          TXB0D1 = vehicle_poll_type;
-          TXB0D2 = vehicle_poll_pid;
-          TXB0D3 = 0x00;
-          TXB0D4 = 0x00;
-          TXB0D5 = 0x00;
-          TXB0D6 = 0x00;
-          TXB0D7 = 0x00;
-          TXB0DLC = 0b00001000; // data length (8)
-          TXB0CON = 0b00001000; // mark for transmission
-          break;
-        case VEHICLE_POLL_TYPE_OBDIIEXTENDED:
-          // 16 bit PID request:
-          TXB0D0 = 0x03;
-          TXB0D1 = VEHICLE_POLL_TYPE_OBDIIEXTENDED;    // Get extended PID
-          TXB0D2 = vehicle_poll_pid >> 8;
-          TXB0D3 = vehicle_poll_pid & 0xff;
-          TXB0D4 = 0x00;
-          TXB0D5 = 0x00;
-          TXB0D6 = 0x00;
-          TXB0D7 = 0x00;
-          TXB0DLC = 0b00001000; // data length (8)
-          TXB0CON = 0b00001000; // mark for transmission
-          break;
+        p = vehicle_poll_plist + vehicle_poll_batchidx[k];
+        if (p->pid == did)
+          vehicle_poll_dxlen = 2 + p->rlen;
         }
-      
-      vehicle_poll_plcur++;
-      return;
+      if (vehicle_poll_dxlen == 0)
+        vehicle_poll_ml_errors++; // unknown DID, can't split remaining data
+      }
+    else if (vehicle_poll_dxpos == vehicle_poll_dxlen)
+      {
+      // DID data complete:
+      vehicle_poll_dxbuf[0] = vehicle_poll_dxlen + 1;
+      vehicle_poll_dxbuf[1] = 0x62;
+      memcpy((void*)can_databuffer, (void*)vehicle_poll_dxbuf, 8);
+      can_datalength = 8;
+      vehicle_poll_pid = did;
+      vehicle_fn_poll0();
+      memset((void*)vehicle_poll_dxbuf, 0, 8);
+      vehicle_poll_dxpos = 0;
+      vehicle_poll_dxlen = 2;
       }
-    vehicle_poll_plcur++;
     }
+  }
 
-  vehicle_poll_plcur = vehicle_poll_plist;
-  vehicle_poll_ticker++;
-  if (vehicle_poll_ticker > 3600) vehicle_poll_ticker -= 3600;
+// Receive batched 0x22 response (single or multi frame):
+void vehicle_poll_batchrx(void)
+  {
+  unsigned char f[8];
+  unsigned char n;
+
+  // can_databuffer is reused by the demultiplexer:
+  memcpy((void*)f, (void*)can_databuffer, 8);
+
+  switch (f[0] >> 4)
+    {
+    case 0x0:
+      // Single frame:
+      n = f[0] & 0x0f;
+      if ((f[1] != 0x62)||(n < 1)||(n > 7))
+        break;
+      vehicle_poll_response();
+      memset((void*)vehicle_poll_dxbuf, 0, 8);
+      vehicle_poll_dxpos = 0;
+      vehicle_poll_dxlen = 2;
+      vehicle_poll_demux(f+2, n-1);
+      break;
+    case 0x1:
+      // First frame: 0x62 + 5 data bytes
+      if (f[2] != 0x62)
+        break;
+      vehicle_poll_ml_remain = (((unsigned int)(f[0]&0x0f))<<8)+f[1] - 6;
+      vehicle_poll_ml_offset = 6;
+      vehicle_poll_ml_frame = 0;
+      vehicle_poll_ml_seq = 1;
+      vehicle_poll_ml_timer = VEHICLE_POLL_ML_TIMEOUT;
+      vehicle_poll_sendfc();
+      vehicle_poll_response();
+      memset((void*)vehicle_poll_dxbuf, 0, 8);
+      vehicle_poll_dxpos = 0;
+      vehicle_poll_dxlen = 2;
+      vehicle_poll_demux(f+3, 5);
+      break;
+    case 0x2:
+      // Consecutive frame:
+      if (vehicle_poll_ml_remain == 0)
+        break;
+      if ((f[0] & 0x0f) != vehicle_poll_ml_seq)
+        {
+        vehicle_poll_ml_remain = 0;
+        vehicle_poll_ml_errors++;
+        break;
+        }
+      vehicle_poll_ml_seq = (vehicle_poll_ml_seq + 1) & 0x0f;
+      vehicle_poll_ml_timer = VEHICLE_POLL_ML_TIMEOUT;
+      n = (vehicle_poll_ml_remain > 7) ? 7 : vehicle_poll_ml_remain;
+      vehicle_poll_ml_remain -= n;
+      vehicle_poll_ml_offset += n;
+      vehicle_poll_ml_frame++;
+      if ((vehicle_poll_bs > 0)&&(vehicle_poll_ml_remain > 0)&&(--vehicle_poll_ml_bscnt == 0))
+        vehicle_poll_sendfc();
+      vehicle_poll_demux(f+1, n);
+      break;
+    }
   }
 
 BOOL vehicle_poll_poll0(void)
@@ -211,7 +798,10 @@ BOOL vehicle_poll_poll0(void)
       // 8 bit PID single frame response:
       if ((can_databuffer[1] == 0x40+vehicle_poll_type)&&
           (can_databuffer[2] == vehicle_poll_pid))
+        {
+        vehicle_poll_response();
         return TRUE; // Call vehicle poller
+        }
       break;
     case VEHICLE_POLL_TYPE_OBDIIVEHICLE:
     case VEHICLE_POLL_TYPE_OBDIIGROUP:
@@ -220,50 +810,37 @@ BOOL vehicle_poll_poll0(void)
           (can_databuffer[2] == 0x40+vehicle_poll_type)&&
           (can_databuffer[3] == vehicle_poll_pid))
         {
-        // First frame; send flow control frame:
-        
-        while ((TXB0CON & 0b00111000) == 0b00001000) {} // wait for TX done / error
-        TXB0CON = 0; // init new TX / abort TX error
-        while (TXB0CONbits.TXREQ) {} // wait for TX clear
-        
-        if (vehicle_poll_moduleid_send == 0x7df)
-          {
-          // broadcast request: derive module ID from response ID:
-          // (Note: this only works for the SAE standard ID scheme)
-          TXB0SIDL = ((can_id-8) & 0x07) << 5;
-          TXB0SIDH = ((can_id-8) >> 3);
-          }
-        else
-          {
-          // use known module ID:
-          TXB0SIDL = (vehicle_poll_moduleid_send & 0x07) << 5;
-          TXB0SIDH = (vehicle_poll_moduleid_send >> 3);
-          }
-        
-        TXB0D0 = 0x30; // flow control frame type
-        TXB0D1 = 0x00; // request all frames available
-        TXB0D2 = 0x32; // with 50ms send interval
-        TXB0D3 = 0x00;
-        TXB0D4 = 0x00;
-        TXB0D5 = 0x00;
-        TXB0D6 = 0x00;
-        TXB0D7 = 0x00;
-        TXB0DLC = 0b00001000; // data length (8)
-        TXB0CON = 0b00001000; // mark for transmission
-        
-        // prepare frame processing, first frame contains first 3 bytes:
-        vehicle_poll_ml_remain = (((unsigned int)(can_databuffer[0]&0xf0))<<8)+can_databuffer[1] - 3;
+        // First frame; init reassembly & send flow control frame:
+        // (message length includes 3 header bytes + 3 data bytes in this frame)
+        vehicle_poll_ml_remain = (((unsigned int)(can_databuffer[0]&0x0f))<<8)+can_databuffer[1] - 6;
         vehicle_poll_ml_offset = 3;
         vehicle_poll_ml_frame = 0;
+        vehicle_poll_ml_seq = 1;
+        vehicle_poll_ml_timer = VEHICLE_POLL_ML_TIMEOUT;
+        vehicle_poll_sendfc();
+        vehicle_poll_response();
+        
+        // first frame contains first 3 bytes:
         can_datalength = 3;
         can_databuffer[0] = can_databuffer[5];
         can_databuffer[1] = can_databuffer[6];
         can_databuffer[2] = can_databuffer[7];
+        if (vehicle_poll_rxbuf != NULL)
+          return vehicle_poll_rxstore();
         return TRUE; // Call vehicle poller
         }
       else if (((can_databuffer[0]>>4)==0x2)&&(vehicle_poll_ml_remain>0))
         {
         // Consecutive frame (1 control + 7 data bytes)
+        if ((can_databuffer[0] & 0x0f) != vehicle_poll_ml_seq)
+          {
+          // frame lost / out of sequence: abort reception
+          vehicle_poll_ml_remain = 0;
+          vehicle_poll_ml_errors++;
+          return FALSE;
+          }
+        vehicle_poll_ml_seq = (vehicle_poll_ml_seq + 1) & 0x0f;
+        vehicle_poll_ml_timer = VEHICLE_POLL_ML_TIMEOUT;
         for (k=0;k<7;k++) { can_databuffer[k] = can_databuffer[k+1]; }
         if (vehicle_poll_ml_remain>7)
           {
@@ -278,22 +855,435 @@ BOOL vehicle_poll_poll0(void)
           vehicle_poll_ml_remain = 0;
           }
         vehicle_poll_ml_frame++;
+        // end of block: request next block
+        if ((vehicle_poll_bs > 0)&&(vehicle_poll_ml_remain > 0)&&(--vehicle_poll_ml_bscnt == 0))
+          vehicle_poll_sendfc();
+        if (vehicle_poll_rxbuf != NULL)
+          return vehicle_poll_rxstore();
         return TRUE;
         }
       break;
     case VEHICLE_POLL_TYPE_OBDIIEXTENDED:
+      if (vehicle_poll_batchcnt > 1)
+        {
+        // Multiple DIDs requested: handler is called per DID
+        vehicle_poll_batchrx();
+        return FALSE;
+        }
       // 16 bit PID response:
       if ((can_databuffer[1] == 0x62)&&
           ((can_databuffer[3]+(((unsigned int) can_databuffer[2]) << 8)) == vehicle_poll_pid))
+        {
+        vehicle_poll_response();
         return TRUE; // Call vehicle poller
+        }
       break;
     }
 
   return FALSE; // Don't call vehicle poller
   }
+#ifndef OVMS_CANRXQUEUE
+#pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 #endif //#ifdef OVMS_POLLER
 
+////////////////////////////////////////////////////////////////////////
+// vehicle_can_setfilters()
+// Setup the ECAN masks and filters from a CAN ID dispatch table.
+// RXB0 has two filters (RXF0-1), RXB1 has four (RXF2-5). If a buffer
+// has more IDs than filters, the mask is reduced to the ID bits common
+// to all of its IDs (so some unlisted IDs may pass).
+// Must be called in CAN configuration mode.
+//
+void vehicle_can_setfilters(rom vehicle_canid_t *list, unsigned char n)
+  {
+  unsigned int mask[2];
+  unsigned int flt[6];
+  unsigned char cnt[2];
+  unsigned char b, i, k, kmax, kmin;
+  unsigned int id;
+
+  // Pass 1: count IDs and collect common ID bits per buffer:
+  mask[0] = mask[1] = 0x7ff;
+  cnt[0] = cnt[1] = 0;
+  for (i=0; i<n; i++)
+    {
+    b = list[i].rxb;
+    if (cnt[b] == 0)
+      flt[b<<1] = list[i].id; // remember first ID
+    else
+      mask[b] &= ~(list[i].id ^ flt[b<<1]);
+    cnt[b]++;
+    }
+  if (cnt[0] <= 2) mask[0] = 0x7ff; // exact match possible
+  if (cnt[1] <= 4) mask[1] = 0x7ff;
+
+  // Pass 2: assign distinct masked IDs to the filters:
+  cnt[0] = cnt[1] = 0;
+  for (i=0; i<n; i++)
+    {
+    b = list[i].rxb;
+    kmin = (b) ? 2 : 0;
+    kmax = (b) ? 4 : 2;
+    id = list[i].id & mask[b];
+    for (k=0; k<cnt[b]; k++)
+      if (flt[kmin+k] == id) break;
+    if ((k == cnt[b]) && (k < kmax))
+      flt[kmin+cnt[b]++] = id;
+    }
+  // Fill unused filters with a copy of the first one (or ID 0):
+  for (k=cnt[0]; k<2; k++)
+    flt[k] = (cnt[0]) ? flt[0] : 0;
+  for (k=cnt[1]; k<4; k++)
+    flt[2+k] = (cnt[1]) ? flt[2] : 0;
+
+  RXM0SIDH = mask[0] >> 3; RXM0SIDL = (mask[0] & 0x07) << 5;
+  RXF0SIDH = flt[0] >> 3;  RXF0SIDL = (flt[0] & 0x07) << 5;
+  RXF1SIDH = flt[1] >> 3;  RXF1SIDL = (flt[1] & 0x07) << 5;
+  RXM1SIDH = mask[1] >> 3; RXM1SIDL = (mask[1] & 0x07) << 5;
+  RXF2SIDH = flt[2] >> 3;  RXF2SIDL = (flt[2] & 0x07) << 5;
+  RXF3SIDH = flt[3] >> 3;  RXF3SIDL = (flt[3] & 0x07) << 5;
+  RXF4SIDH = flt[4] >> 3;  RXF4SIDL = (flt[4] & 0x07) << 5;
+  RXF5SIDH = flt[5] >> 3;  RXF5SIDL = (flt[5] & 0x07) << 5;
+  }
+
+////////////////////////////////////////////////////////////////////////
+// vehicle_can_tx()
+// Send a CAN frame (standard ID, len <= 8).
+// Note: may be called from ISR context
+//
+#ifdef OVMS_CANTXQUEUE
+
+// Load a frame into TX buffer 1. The queue only uses TXB1: with two
+// buffers of equal TXPRI the ECAN sends the higher numbered one first,
+// which would reorder frames (i.e. ISO-TP consecutive frames).
+// Called by the ISR and by vehicle_can_tx() with interrupts disabled.
+#pragma tmpdata high_isr_tmpdata
+void vehicle_txq_load(unsigned int id, unsigned char prio,
+                      unsigned char len, unsigned char *data)
+  {
+  volatile far unsigned char *txb1 = &TXB1D0;
+  unsigned char i;
+
+  if (TXB1CON & 0b01010000)     // TXABT / TXERR from last transmission
+    vehicle_txq_errors++;
+  TXB1CON = 0;
+  TXB1SIDH = id >> 3;
+  TXB1SIDL = (id & 0x07) << 5;
+  for (i=0; i<len; i++)
+    txb1[i] = data[i];
+  TXB1DLC = len;
+  TXB1CON = 0b00001000 | prio;  // mark for transmission
+  }
+
+// Runs with interrupts disabled, so it can share the ISR tmpdata:
+BOOL vehicle_can_tx(unsigned int id, unsigned char prio, unsigned char len, unsigned char *data)
+  {
+  unsigned char gie, i, k;
+  vehicle_txq_frame_t *f;
+  BOOL res = TRUE;
+
+  gie = INTCONbits.GIEH;
+  INTCONbits.GIEH = 0;
+
+  if (len > 8) len = 8;
+
+  if ((vehicle_txq_cnt == 0)&&(!TXB1CONbits.TXREQ))
+    {
+    vehicle_txq_load(id, prio, len, data);
+    }
+  else if (vehicle_txq_cnt == VEHICLE_TXQ_SIZE)
+    {
+    vehicle_txq_dropped++;
+    res = FALSE;
+    }
+  else
+    {
+    // queue frame, high priority frames go in front of the normal ones
+    // (keeping their order):
+    if (prio == VEHICLE_TXPRI_HIGH)
+      {
+      for (k=vehicle_txq_cnt; k>vehicle_txq_highcnt; k--)
+        vehicle_txq[(vehicle_txq_first + k) & (VEHICLE_TXQ_SIZE - 1)] =
+          vehicle_txq[(vehicle_txq_first + k - 1) & (VEHICLE_TXQ_SIZE - 1)];
+      i = (vehicle_txq_first + vehicle_txq_highcnt) & (VEHICLE_TXQ_SIZE - 1);
+      vehicle_txq_highcnt++;
+      }
+    else
+      {
+      i = (vehicle_txq_first + vehicle_txq_cnt) & (VEHICLE_TXQ_SIZE - 1);
+      }
+    f = &vehicle_txq[i];
+    f->id = id;
+    f->prio = prio;
+    f->len = len;
+    memcpy((void*)f->data, (void*)data, len);
+    if (++vehicle_txq_cnt > vehicle_txq_maxdepth)
+      vehicle_txq_maxdepth = vehicle_txq_cnt;
+    PIE3bits.TXB1IE = 1;
+    }
+
+  if (gie) INTCONbits.GIEH = 1;
+  return res;
+  }
+#pragma tmpdata
+
+// vehicle_can_txisr: refill TX buffer 1 from the queue
+// (called by high_isr)
+#pragma tmpdata high_isr_tmpdata
+void vehicle_can_txisr(void)
+  {
+  vehicle_txq_frame_t *f;
+
+  PIR3bits.TXB1IF = 0;
+
+  if ((vehicle_txq_cnt > 0)&&(!TXB1CONbits.TXREQ))
+    {
+    f = &vehicle_txq[vehicle_txq_first];
+    vehicle_txq_load(f->id, f->prio, f->len, f->data);
+    vehicle_txq_first = (vehicle_txq_first + 1) & (VEHICLE_TXQ_SIZE - 1);
+    vehicle_txq_cnt--;
+    if (vehicle_txq_highcnt > 0)
+      vehicle_txq_highcnt--;
+    }
+
+  if (vehicle_txq_cnt == 0)
+    {
+    PIE3bits.TXB1IE = 0;
+    }
+  }
+#pragma tmpdata
+
+#else // #ifdef OVMS_CANTXQUEUE
+
+// Loads TXB0 with interrupts disabled, so it can share the ISR tmpdata
+// and an ISR frame cannot overwrite a main loop frame:
+#pragma tmpdata high_isr_tmpdata
+BOOL vehicle_can_tx(unsigned int id, unsigned char prio, unsigned char len, unsigned char *data)
+  {
+  volatile far unsigned char *txb0 = &TXB0D0;
+  unsigned char gie, i;
+
+  gie = INTCONbits.GIEH;
+  for (;;)
+    {
+    while ((TXB0CON & 0b00111000) == 0b00001000) {} // wait for TX done / error
+    INTCONbits.GIEH = 0;
+    if ((TXB0CON & 0b00111000) != 0b00001000)
+      break;
+    if (gie) INTCONbits.GIEH = 1; // ISR has loaded a frame meanwhile
+    }
+  TXB0CON = 0; // init new TX / abort TX error
+  while (TXB0CONbits.TXREQ) {} // wait for TX clear
+
+  if (len > 8) len = 8;
+  TXB0SIDL = (id & 0x07) << 5;
+  TXB0SIDH = (id >> 3);
+  for (i=0; i<len; i++)
+    txb0[i] = data[i];
+  TXB0DLC = len; // data length
+  TXB0CON = 0b00001000 | prio; // mark for transmission
+
+  if (gie) INTCONbits.GIEH = 1;
+  return TRUE;
+  }
+#pragma tmpdata
+
+#endif // #ifdef OVMS_CANTXQUEUE
+
+#ifdef OVMS_CANSTATS
+////////////////////////////////////////////////////////////////////////
+// CAN traffic statistics
+
+// vehicle_canstat_rx: count received frame (called by high_isr)
+// The talker slot is found by hashing the ID, checking at most two slots.
+#pragma tmpdata high_isr_tmpdata
+void vehicle_canstat_rx(unsigned char rxb, unsigned int id, unsigned char len)
+  {
+  vehicle_canstat_t *e, *e2;
+  unsigned char k;
+
+  vehicle_canstat_frames[rxb]++;
+  vehicle_canstat_secframes++;
+  vehicle_canstat_secbytes += len;
+
+  k = (id ^ (id >> 4) ^ (id >> 8)) & (VEHICLE_CANSTAT_SIZE - 1);
+  e = &vehicle_canstat[k];
+  if ((e->id != id)&&(e->frames != 0))
+    {
+    e2 = &vehicle_canstat[(k + 1) & (VEHICLE_CANSTAT_SIZE - 1)];
+    if ((e2->id == id)||(e2->frames == 0)||(e2->frames < e->frames))
+      e = e2; // (both used by other IDs: replace the less frequent one)
+    }
+  e->id = id;
+  e->frames++;
+  e->bytes += len;
+  }
+#pragma tmpdata
+
+// vehicle_canstat_getframes: frames received in RX buffer rxb
+unsigned long vehicle_canstat_getframes(unsigned char rxb)
+  {
+  unsigned long frames;
+
+  INTCONbits.GIEH = 0;
+  frames = vehicle_canstat_frames[rxb];
+  INTCONbits.GIEH = 1;
+  return frames;
+  }
+
+// vehicle_canstat_top: copy the next top talker into *e
+// (*done: bit mask of the slots already reported, start with 0)
+// Returns FALSE if all used slots have been reported.
+BOOL vehicle_canstat_top(unsigned int *done, vehicle_canstat_t *e)
+  {
+  unsigned char k, top;
+  unsigned int bit;
+
+  INTCONbits.GIEH = 0;
+  top = 0xff;
+  for (k=0, bit=1; k<VEHICLE_CANSTAT_SIZE; k++, bit<<=1)
+    {
+    if ((vehicle_canstat[k].frames > 0) && ((*done & bit) == 0)
+      && ((top == 0xff) || (vehicle_canstat[k].frames > vehicle_canstat[top].frames)))
+      top = k;
+    }
+  if (top != 0xff)
+    *e = vehicle_canstat[top];
+  INTCONbits.GIEH = 1;
+
+  if (top == 0xff)
+    return FALSE;
+  *done |= (1 << top);
+  return TRUE;
+  }
+
+void vehicle_canstat_reset(void)
+  {
+  unsigned char gie;
+
+  gie = INTCONbits.GIEH;
+  INTCONbits.GIEH = 0;
+  memset((void*)vehicle_canstat, 0, sizeof(vehicle_canstat));
+  vehicle_canstat_frames[0] = vehicle_canstat_frames[1] = 0;
+  vehicle_canstat_secframes = vehicle_canstat_secbytes = 0;
+  vehicle_can_overflow[0] = vehicle_can_overflow[1] = 0;
+  if (gie) INTCONbits.GIEH = 1;
+  vehicle_canstat_secs = 0;
+  vehicle_canstat_fps = vehicle_canstat_fpsmax = 0;
+  vehicle_canstat_load = vehicle_canstat_loadavg = vehicle_canstat_loadmax = 0;
+  }
+
+// vehicle_canstat_ticker: frame rate & bus load (called once per second)
+void vehicle_canstat_ticker(void)
+  {
+  unsigned int bytes;
+  unsigned long bits;
+
+  INTCONbits.GIEH = 0;
+  vehicle_canstat_fps = vehicle_canstat_secframes;
+  bytes = vehicle_canstat_secbytes;
+  vehicle_canstat_secframes = vehicle_canstat_secbytes = 0;
+  INTCONbits.GIEH = 1;
+
+  // Bit rate: Fosc/2 = 10 MHz / (BRP+1) / TQ per bit
+  vehicle_canstat_kbps = 10000 / (((BRGCON1 & 0x3f) + 1) *
+          (4 + (BRGCON2 & 0x07) + ((BRGCON2 >> 3) & 0x07) + (BRGCON3 & 0x07)));
+
+  // Standard frame: 47 bits + 8 per data byte (w/o stuff bits)
+  bits = (unsigned long) vehicle_canstat_fps * 47 + (unsigned long) bytes * 8;
+  bits /= (unsigned long) vehicle_canstat_kbps * 10;
+  vehicle_canstat_load = (bits > 100) ? 100 : bits;
+
+  if (vehicle_canstat_fps > vehicle_canstat_fpsmax)
+    vehicle_canstat_fpsmax = vehicle_canstat_fps;
+  if (vehicle_canstat_load > vehicle_canstat_loadmax)
+    vehicle_canstat_loadmax = vehicle_canstat_load;
+  vehicle_canstat_loadavg = (((unsigned int) vehicle_canstat_loadavg * 7)
+          + vehicle_canstat_load + 4) >> 3;
+  if (vehicle_canstat_secs < 0xffff)
+    vehicle_canstat_secs++;
+  }
+#endif //#ifdef OVMS_CANSTATS
+
+#ifdef OVMS_CANCACHE
+////////////////////////////////////////////////////////////////////////
+// CAN payload change cache
+//
+
+// vehicle_cancache_setids: register 0 terminated ID list (NULL = off)
+void vehicle_cancache_setids(rom unsigned int *ids)
+  {
+  vehicle_cancache_ids = ids;
+  vehicle_cancache_invalidate();
+  }
+
+// vehicle_cancache_check: TRUE if can_* frame is unchanged (skip decoding)
+// (called by high_isr unless OVMS_CANRXQUEUE is defined)
+#ifndef OVMS_CANRXQUEUE
+#pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
+BOOL vehicle_cancache_check(void)
+  {
+  rom unsigned int *p;
+  vehicle_cancache_t *e;
+  unsigned char k;
+
+  if (vehicle_cancache_ids == NULL)
+    return FALSE;
+  for (p=vehicle_cancache_ids, k=0; k<VEHICLE_CANCACHE_SIZE; p++, k++)
+    {
+    if ((*p == 0) || (*p == can_id))
+      break;
+    }
+  if ((k == VEHICLE_CANCACHE_SIZE) || (*p == 0))
+    return FALSE; // not cached
+
+  if (vehicle_cancache_checks == 0xffff)
+    {
+    vehicle_cancache_checks >>= 1;
+    vehicle_cancache_hits >>= 1;
+    }
+  vehicle_cancache_checks++;
+
+  e = &vehicle_cancache[k];
+  if (e->dlc == can_datalength)
+    {
+    for (k=0; k<can_datalength; k++)
+      {
+      if (e->data[k] != can_databuffer[k])
+        break;
+      }
+    if (k == can_datalength)
+      {
+      vehicle_cancache_hits++;
+      return TRUE;
+      }
+    }
+
+  for (k=0; k<can_datalength; k++)
+    e->data[k] = can_databuffer[k];
+  e->dlc = can_datalength;
+  return FALSE;
+  }
+#ifndef OVMS_CANRXQUEUE
+#pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
+
+// vehicle_cancache_invalidate: pass on next frame of all IDs
+void vehicle_cancache_invalidate(void)
+  {
+  unsigned char gie, k;
+
+  gie = INTCONbits.GIEH;
+  INTCONbits.GIEH = 0;
+  for (k=0; k<VEHICLE_CANCACHE_SIZE; k++)
+    vehicle_cancache[k].dlc = 0xff;
+  if (gie) INTCONbits.GIEH = 1;
+  }
+#endif //#ifdef OVMS_CANCACHE
+
 ////////////////////////////////////////////////////////////////////////
 // CAN Interrupt Service Routine (High Priority)
 //
@@ -323,6 +1313,13 @@ void high_isr(void)
     // Check RX buffer 0:
     if (RXB0CONbits.RXFUL)
       {
+#ifdef OVMS_CANSTATS
+      vehicle_canstat_rx(0, ((unsigned int)RXB0SIDL >>5) + ((unsigned int)RXB0SIDH <<3),
+              RXB0DLC & 0x0F);
+#endif //#ifdef OVMS_CANSTATS
+#ifdef OVMS_CANRXQUEUE
+      VEHICLE_RXQ_PUT(0, 0x01);
+#else // #ifdef OVMS_CANRXQUEUE
       if (vehicle_fn_poll0 != NULL)
         {
         can_id = ((unsigned int)RXB0SIDL >>5)
@@ -339,6 +1336,13 @@ void high_isr(void)
         can_databuffer[7] = RXB0D7;
         RXB0CONbits.RXFUL = 0; // All bytes read, Clear flag
         PIR3bits.RXB0IF = 0;   // reset interrupt flag
+#ifdef OVMS_CANCACHE
+        if (vehicle_cancache_check())
+          {
+          // payload unchanged, skip decoding
+          }
+        else
+#endif //#ifdef OVMS_CANCACHE
 #ifdef OVMS_POLLER
         if (vehicle_poll_plist != NULL)
           {
@@ -365,11 +1369,19 @@ void high_isr(void)
         RXB0CONbits.RXFUL = 0; // reset buffer flag
         PIR3bits.RXB0IF = 0;   // reset interrupt flag
         }
+#endif // #ifdef OVMS_CANRXQUEUE
       }
     
     // Check RX buffer 1:
     if (RXB1CONbits.RXFUL)
       {
+#ifdef OVMS_CANSTATS
+      vehicle_canstat_rx(1, ((unsigned int)RXB1SIDL >>5) + ((unsigned int)RXB1SIDH <<3),
+              RXB1DLC & 0x0F);
+#endif //#ifdef OVMS_CANSTATS
+#ifdef OVMS_CANRXQUEUE
+      VEHICLE_RXQ_PUT(1, 0x07);
+#else // #ifdef OVMS_CANRXQUEUE
       if (vehicle_fn_poll1 != NULL)
         {
 #ifdef OVMS_POLLER
@@ -389,6 +1401,9 @@ void high_isr(void)
         can_databuffer[7] = RXB1D7;
         RXB1CONbits.RXFUL = 0;        // All bytes read, Clear flag
         PIR3bits.RXB1IF = 0;          // reset interrupt flag
+#ifdef OVMS_CANCACHE
+        if (!vehicle_cancache_check())
+#endif //#ifdef OVMS_CANCACHE
         vehicle_fn_poll1();
         }
       else
@@ -397,8 +1412,17 @@ void high_isr(void)
         RXB1CONbits.RXFUL = 0; // reset buffer flag
         PIR3bits.RXB1IF = 0;   // reset interrupt flag
         }
+#endif // #ifdef OVMS_CANRXQUEUE
       }
     
+#ifdef OVMS_CANTXQUEUE
+    // Refill TX buffer:
+    if (PIR3bits.TXB1IF)
+      {
+      vehicle_can_txisr();
+      }
+#endif // #ifdef OVMS_CANTXQUEUE
+
     } while (PIR3bits.RXB0IF || PIR3bits.RXB1IF);
   
   }
@@ -406,6 +1430,70 @@ void high_isr(void)
 
 #endif // OVMS_CUSTOM_CAN_ISR
 
+#ifdef OVMS_CANRXQUEUE
+////////////////////////////////////////////////////////////////////////
+// vehicle_rxq_process()
+// Drain the CAN RX queue filled by high_isr. This is called from the
+// main loop, so the vehicle poll handlers no longer run in ISR context
+// and a slow handler can't cause hardware RX buffer overruns.
+//
+void vehicle_rxq_process(void)
+  {
+  vehicle_rxq_frame_t *f;
+  unsigned char rxb;
+
+  while (vehicle_rxq_tail != vehicle_rxq_head)
+    {
+    f = &vehicle_rxq[vehicle_rxq_tail];
+    can_id = f->id;
+    can_filter = f->filter;
+    can_datalength = f->datalength;
+    memcpy((void*)can_databuffer, (void*)f->data, 8);
+    rxb = f->rxb;
+    // slot may now be reused by the ISR:
+    vehicle_rxq_tail = (vehicle_rxq_tail + 1) & (VEHICLE_RXQ_SIZE - 1);
+
+    if (rxb == 0)
+      {
+      if (vehicle_fn_poll0 == NULL) continue;
+#ifdef OVMS_CANCACHE
+      if (vehicle_cancache_check()) continue;
+#endif //#ifdef OVMS_CANCACHE
+#ifdef OVMS_POLLER
+      if (vehicle_poll_plist != NULL)
+        {
+        if ((can_id >= vehicle_poll_moduleid_low)&&
+            (can_id <= vehicle_poll_moduleid_high))
+          {
+          if (vehicle_poll_poll0())
+            {
+            vehicle_fn_poll0();
+            }
+          }
+        }
+      else
+        {
+        vehicle_fn_poll0();
+        }
+#else // #ifdef OVMS_POLLER
+      vehicle_fn_poll0();
+#endif //#ifdef OVMS_POLLER
+      }
+    else
+      {
+      if (vehicle_fn_poll1 == NULL) continue;
+#ifdef OVMS_POLLER
+      vehicle_poll_busactive = 60; // Reset countdown timer for passive bus activity
+#endif //#ifdef OVMS_POLLER
+#ifdef OVMS_CANCACHE
+      if (vehicle_cancache_check()) continue;
+#endif //#ifdef OVMS_CANCACHE
+      vehicle_fn_poll1();
+      }
+    }
+  }
+#endif // #ifdef OVMS_CANRXQUEUE
+
 ////////////////////////////////////////////////////////////////////////
 // vehicle_initialise()
 // This function is an entry point from the main() program loop, and
@@ -414,6 +1502,9 @@ void high_isr(void)
 void vehicle_initialise(void)
   {
   char *p;
+#ifdef OVMS_POLLER
+  unsigned char k;
+#endif
 
   can_granular_tick = 0;
   can_minSOCnotified = 0;
@@ -430,8 +1521,48 @@ void vehicle_initialise(void)
   vehicle_poll_pid = 0;
   vehicle_poll_busactive = 0;
   vehicle_fn_pollpid = NULL;
+  vehicle_poll_nextidx = 0xff;
+  vehicle_poll_ml_remain = 0;
+  vehicle_poll_ml_timer = 0;
+  vehicle_poll_ml_errors = 0;
+  vehicle_poll_ml_timeouts = 0;
+  vehicle_poll_rxbuf = NULL;
+  vehicle_poll_rxbufsize = 0;
+  vehicle_poll_waiting = 0;
+  vehicle_poll_batchcnt = 0;
+  vehicle_pollcfg.magic = 0;
+  memset((void*)vehicle_poll_stats, 0, sizeof(vehicle_poll_stats));
+  for (k=0; k<VEHICLE_POLL_NSTATES; k++)
+    {
+    vehicle_poll_latemax[k] = 0;
+    vehicle_poll_latesum[k] = 0;
+    vehicle_poll_latecnt[k] = 0;
+    }
 #endif //#ifdef OVMS_POLLER
 
+#ifdef OVMS_CANRXQUEUE
+  vehicle_rxq_head = 0;
+  vehicle_rxq_tail = 0;
+  vehicle_rxq_maxdepth = 0;
+  vehicle_rxq_dropped[0] = 0;
+  vehicle_rxq_dropped[1] = 0;
+#endif //#ifdef OVMS_CANRXQUEUE
+
+#if defined(OVMS_CANRXQUEUE) || defined(OVMS_CANSTATS)
+  vehicle_can_overflow[0] = 0;
+  vehicle_can_overflow[1] = 0;
+#endif
+
+#ifdef OVMS_CANSTATS
+  vehicle_canstat_reset();
+#endif //#ifdef OVMS_CANSTATS
+
+#ifdef OVMS_CANCACHE
+  vehicle_cancache_setids(NULL);
+  vehicle_cancache_checks = 0;
+  vehicle_cancache_hits = 0;
+#endif //#ifdef OVMS_CANCACHE
+
   vehicle_version = NULL;
   vehicle_fn_init = NULL;
   vehicle_fn_poll0 = NULL;
@@ -564,7 +1695,17 @@ void vehicle_initialise(void)
   RCONbits.IPEN = 1; // Enable Interrupt Priority
   PIE3bits.RXB1IE = 1; // CAN Receive Buffer 1 Interrupt Enable bit
   PIE3bits.RXB0IE = 1; // CAN Receive Buffer 0 Interrupt Enable bit
+#ifdef OVMS_CANTXQUEUE
+  vehicle_txq_first = 0;
+  vehicle_txq_cnt = 0;
+  vehicle_txq_highcnt = 0;
+  vehicle_txq_maxdepth = 0;
+  vehicle_txq_dropped = 0;
+  vehicle_txq_errors = 0;
+  IPR3 = 0b00011011; // high priority interrupts for RX Buffers 0+1 and TX Buffers 1+2
+#else
   IPR3 = 0b00000011; // high priority interrupts for Buffers 0 and 1
+#endif
   }
 
 ////////////////////////////////////////////////////////////////////////
@@ -584,6 +1725,14 @@ void vehicle_ticker(void)
     }
 #endif //#ifdef OVMS_POLLER
 
+#ifdef OVMS_CANSTATS
+  vehicle_canstat_ticker();
+#endif //#ifdef OVMS_CANSTATS
+
+#ifdef OVMS_CANCACHE
+  vehicle_cancache_invalidate();
+#endif //#ifdef OVMS_CANCACHE
+
   // The one-second work...
   if (car_stale_ambient>0) car_stale_ambient--;
   if (car_stale_temps>0)   car_stale_temps--;
@@ -605,12 +1754,18 @@ void vehicle_ticker(void)
    */
     if( COMSTATbits.RXB0OVFL )
       {
+#if defined(OVMS_CANRXQUEUE) || defined(OVMS_CANSTATS)
+      vehicle_can_overflow[0]++;
+#endif
       RXB0CONbits.RXFUL = 0; // clear buffer full flag
       PIR3bits.RXB0IF = 0; // clear interrupt flag
       COMSTATbits.RXB0OVFL = 0; // clear buffer overflow bit
       }
     if( COMSTATbits.RXB1OVFL )
       {
+#if defined(OVMS_CANRXQUEUE) || defined(OVMS_CANSTATS)
+      vehicle_can_overflow[1]++;
+#endif
       RXB1CONbits.RXFUL = 0; // clear buffer full flag
       PIR3bits.RXB1IF = 0; // clear interrupt flag
       COMSTATbits.RXB1OVFL = 0; // clear buffer overflow bit
@@ -699,6 +1854,21 @@ void vehicle_ticker(void)
 
 void vehicle_ticker10th(void)
   {
+#ifdef OVMS_POLLER
+  // Multi frame reception timeout:
+  if ((vehicle_poll_ml_timer > 0)&&(--vehicle_poll_ml_timer == 0)&&(vehicle_poll_ml_remain > 0))
+    {
+    INTCONbits.GIEH = 0;
+    vehicle_poll_ml_remain = 0;
+    INTCONbits.GIEH = 1;
+    vehicle_poll_ml_timeouts++;
+    }
+
+  // Response timeout:
+  if (vehicle_poll_waiting > 0)
+    vehicle_poll_timeout(FALSE);
+#endif //#ifdef OVMS_POLLER
+
   if (vehicle_fn_ticker10th != NULL) vehicle_fn_ticker10th();
   }
 
@@ -88,6 +88,179 @@ void vehicle_ticker(void);
 void vehicle_ticker10th(void);
 void vehicle_idlepoll(void);
 
+////////////////////////////////////////////////////////////////////////////////
+// CAN ID tables:
+//
+// A vehicle module can declare the CAN IDs it handles as a rom table sorted
+// by ID:
+//
+//    rom vehicle_canid_t vehicle_xx_canids[] = {
+//      { 0, 0x100 }, { 1, 0x344 }, { 1, 0x402 } };
+//
+// vehicle_can_setfilters() derives the ECAN masks & filters for both RX
+// buffers from the table (call in CAN configuration mode), so IDs not
+// listed never reach the ISR.
+//
+// Dispatch stays a switch on can_id calling one handler per ID: for the
+// few IDs per module the compare chain C18 generates is cheaper than a
+// binary search + table call (see client/canbench.c).
+// Used by the Tesla Roadster. The Kia Soul and Twizy keep their own
+// filter setup: Kia poll0 filters cover the poll list module range, the
+// Twizy custom ISR needs fixed filter hits for its 0x155/0x424 fast path
+// (and its poll0/1 already switch on the filter hit first).
+//
+typedef struct
+{
+  unsigned char rxb;          // receive buffer: 0 / 1
+  unsigned int id;
+} vehicle_canid_t;
+
+void vehicle_can_setfilters(rom vehicle_canid_t *list, unsigned char n);
+
+// CAN transmission:
+// Without OVMS_CANTXQUEUE, vehicle_can_tx() waits for TXB0 to be free.
+// With OVMS_CANTXQUEUE, it returns immediately, FALSE = queue full.
+#define VEHICLE_TXPRI_NORMAL    0
+#define VEHICLE_TXPRI_HIGH      3   // i.e. ISO-TP flow control
+
+BOOL vehicle_can_tx(unsigned int id, unsigned char prio, unsigned char len, unsigned char *data);
+
+#ifdef OVMS_CANTXQUEUE
+#ifdef OVMS_CUSTOM_CAN_ISR
+#error "OVMS_CANTXQUEUE is not compatible with OVMS_CUSTOM_CAN_ISR"
+#endif
+#define VEHICLE_TXQ_SIZE 4    // software queue slots (power of 2)
+
+extern unsigned char vehicle_txq_maxdepth;      // Queue high water mark
+extern unsigned int vehicle_txq_dropped;        // Frames lost due to full queue
+extern unsigned int vehicle_txq_errors;         // TX errors / aborts detected
+
+void vehicle_can_txisr(void);
+#endif //#ifdef OVMS_CANTXQUEUE
+
+#ifdef OVMS_CANRXQUEUE
+// Deferred CAN RX queue: the ISR only copies frames into the queue,
+// the main loop drains it and runs the poll handlers
+// (size must be a power of 2)
+#define VEHICLE_RXQ_SIZE 8
+
+typedef struct
+{
+  unsigned int id;
+  unsigned char rxb;          // receive buffer: 0 / 1
+  unsigned char filter;
+  unsigned char datalength;
+  unsigned char data[8];
+} vehicle_rxq_frame_t;
+
+extern unsigned char vehicle_rxq_head;          // Next slot to be filled by ISR
+extern unsigned char vehicle_rxq_tail;          // Next slot to be processed
+extern unsigned char vehicle_rxq_maxdepth;      // Queue high water mark
+extern unsigned int vehicle_rxq_dropped[2];     // Frames lost due to full queue (per RXB)
+extern vehicle_rxq_frame_t vehicle_rxq[VEHICLE_RXQ_SIZE];
+
+void vehicle_rxq_process(void);
+
+// VEHICLE_RXQ_PUT: copy RX buffer n (0/1) into the queue, count queue full
+// drops and hardware overflows, release the buffer. fmask: FILHIT bits.
+// Used by high_isr and by custom vehicle ISRs (i.e. Twizy).
+#define VEHICLE_RXQ_PUT(n, fmask) \
+  { \
+  unsigned char h = (vehicle_rxq_head + 1) & (VEHICLE_RXQ_SIZE - 1); \
+  vehicle_rxq_frame_t *f; \
+  if (h == vehicle_rxq_tail) \
+    { \
+    vehicle_rxq_dropped[n]++; \
+    } \
+  else \
+    { \
+    f = &vehicle_rxq[vehicle_rxq_head]; \
+    f->id = ((unsigned int)RXB##n##SIDL >>5) \
+          + ((unsigned int)RXB##n##SIDH <<3); \
+    f->rxb = n; \
+    f->filter = RXB##n##CON & fmask; \
+    f->datalength = RXB##n##DLC & 0x0F; \
+    f->data[0] = RXB##n##D0; \
+    f->data[1] = RXB##n##D1; \
+    f->data[2] = RXB##n##D2; \
+    f->data[3] = RXB##n##D3; \
+    f->data[4] = RXB##n##D4; \
+    f->data[5] = RXB##n##D5; \
+    f->data[6] = RXB##n##D6; \
+    f->data[7] = RXB##n##D7; \
+    vehicle_rxq_head = h; \
+    h = (h - vehicle_rxq_tail) & (VEHICLE_RXQ_SIZE - 1); \
+    if (h > vehicle_rxq_maxdepth) vehicle_rxq_maxdepth = h; \
+    } \
+  if (COMSTATbits.RXB##n##OVFL) \
+    { \
+    vehicle_can_overflow[n]++; \
+    COMSTATbits.RXB##n##OVFL = 0; \
+    } \
+  RXB##n##CONbits.RXFUL = 0; \
+  PIR3bits.RXB##n##IF = 0; \
+  }
+#endif //#ifdef OVMS_CANRXQUEUE
+
+#if defined(OVMS_CANRXQUEUE) || defined(OVMS_CANSTATS)
+extern unsigned int vehicle_can_overflow[2];    // Hardware RXBnOVFL counts (per RXB)
+#endif
+
+#ifdef OVMS_CANSTATS
+// CAN traffic statistics (frames accepted by the RX filters):
+// the talker table is a hash table on the ID (two slots checked per
+// frame, so the ISR cost does not depend on the table size). If both
+// slots hold other IDs, the new ID replaces the less frequent one and
+// inherits its counts, so counts of rare IDs are upper bounds.
+// Read by vehicle_canstat_top in frame count order.
+#define VEHICLE_CANSTAT_SIZE 16     // power of 2, max 16 (vehicle_canstat_top)
+
+typedef struct
+{
+  unsigned int id;
+  unsigned long frames;       // 0 = unused entry
+  unsigned long bytes;
+} vehicle_canstat_t;
+
+extern vehicle_canstat_t vehicle_canstat[VEHICLE_CANSTAT_SIZE]; // Top talkers
+extern unsigned long vehicle_canstat_frames[2]; // Frames per RX buffer
+extern unsigned int vehicle_canstat_secs;       // Seconds since reset
+extern unsigned int vehicle_canstat_kbps;       // Bit rate (from BRGCON)
+extern unsigned int vehicle_canstat_fps;        // Frames/sec last second
+extern unsigned int vehicle_canstat_fpsmax;     // Frames/sec max
+extern unsigned char vehicle_canstat_load;      // Bus load % last second
+extern unsigned char vehicle_canstat_loadavg;   // Bus load % moving average
+extern unsigned char vehicle_canstat_loadmax;   // Bus load % max
+
+void vehicle_canstat_rx(unsigned char rxb, unsigned int id, unsigned char len);
+unsigned long vehicle_canstat_getframes(unsigned char rxb);
+BOOL vehicle_canstat_top(unsigned int *done, vehicle_canstat_t *e);
+void vehicle_canstat_reset(void);
+#endif //#ifdef OVMS_CANSTATS
+
+#ifdef OVMS_CANCACHE
+// CAN payload change cache: frames of the IDs registered by the vehicle
+// module are only passed on to the poll handler if their payload differs
+// from the last one seen. Only register IDs whose handler just copies
+// state (no counters, averages, edge detection or multiplexing).
+// All entries are invalidated once per second, so unchanged frames still
+// reach the handler at least once per second (stale timers, CAN writes).
+#define VEHICLE_CANCACHE_SIZE 8
+
+typedef struct
+{
+  unsigned char dlc;          // 0xff = invalid
+  unsigned char data[8];
+} vehicle_cancache_t;
+
+extern unsigned int vehicle_cancache_checks;    // Frames checked
+extern unsigned int vehicle_cancache_hits;      // Frames skipped (unchanged)
+
+void vehicle_cancache_setids(rom unsigned int *ids);
+BOOL vehicle_cancache_check(void);
+void vehicle_cancache_invalidate(void);
+#endif //#ifdef OVMS_CANCACHE
+
 #ifdef OVMS_POLLER
 // Vehicle Poller functions and data
 
@@ -101,10 +274,37 @@ void vehicle_idlepoll(void);
 //      unsigned char type; // see vehicle.h
 //      unsigned int pid; // the PID to request
 //      unsigned int polltime[VEHICLE_POLL_NSTATES]; // poll frequency
+//      unsigned char stmin; // ISO-TP flow control separation time (optional)
+//      unsigned char bs; // ISO-TP flow control block size (optional)
+//      unsigned char rlen; // 0x22 response data length (optional)
+//      unsigned char *rxbuf; // multi frame reassembly buffer (optional)
+//      unsigned char rxsize; // size of rxbuf
 //    } vehicle_pid_t;
 //
 // polltime[state] = poll period in seconds, i.e. 10 = poll every 10 seconds
 //
+// stmin / bs are only used for multi frame responses:
+//   stmin = 0 => default 50 ms, 1..127 => ms, 0xF1..0xF9 => 100..900 us
+//           (use VEHICLE_POLL_STMIN_FAST for the minimum separation time)
+//   bs = number of consecutive frames to receive before the next flow
+//        control frame is sent, 0 = all frames
+//
+// rlen = response data length of a VEHICLE_POLL_TYPE_OBDIIEXTENDED DID
+//   (1..4 bytes, 0 = unknown). DIDs with rlen set for the same module are
+//   requested together (max VEHICLE_POLL_MAXBATCH DIDs per request) when
+//   due within half of their period. The response is split up again, the
+//   poll0 hook is called once per DID with a single frame response as if
+//   the DID had been requested alone (rxbuf is not used for batches).
+//   Batching is off by default (rlen 0 in all lists): only set rlen after
+//   verifying on the car that the ECU answers multiple DIDs per
+//   ReadDataByIdentifier request.
+//
+// rxbuf / rxsize = multi frame reassembly buffer for this entry: if set,
+//   the response data is collected in rxbuf (max rxsize bytes, excess is
+//   dropped), and the poll0 hook is called only once after the last frame
+//   (vehicle_poll_ml_remain = 0, vehicle_poll_ml_offset = total length,
+//   can_datalength = 0). Without rxbuf the hook is called once per frame.
+//
 // state: 0..2; set by vehicle_poll_setstate()
 //     0=off, 1=on, 2=charging
 // 
@@ -118,6 +318,10 @@ void vehicle_idlepoll(void);
 
 #define VEHICLE_POLL_NSTATES 3
 
+// Max number of poll list entries handled by the scheduler
+// (entries beyond this limit are not polled)
+#define VEHICLE_POLL_MAXPIDS 16
+
 // Polling types supported:
 //  (see https://en.wikipedia.org/wiki/OBD-II_PIDs
 //   and https://en.wikipedia.org/wiki/Unified_Diagnostic_Services)
@@ -136,8 +340,43 @@ typedef struct
   unsigned char type;
   unsigned int pid;
   unsigned int polltime[VEHICLE_POLL_NSTATES];
+  unsigned char stmin;
+  unsigned char bs;
+  unsigned char rlen;
+  unsigned char *rxbuf;
+  unsigned char rxsize;
 } vehicle_pid_t;
 
+// 0x22 DID batching: max DIDs per request (single request frame), max rlen
+#define VEHICLE_POLL_MAXBATCH           3
+#define VEHICLE_POLL_MAXRLEN            4
+
+#define VEHICLE_POLL_STMIN_DEFAULT      0x32 // 50 ms
+#define VEHICLE_POLL_STMIN_FAST         0xF1 // 100 us
+
+// Multi frame reception timeout (1/10 seconds between frames):
+#define VEHICLE_POLL_ML_TIMEOUT         10
+
+// Response timeout (1/10 seconds), retries & back-off:
+//  a request not answered within the timeout is retried up to RETRIES
+//  times, after that the poll period is doubled for each further failure
+//  up to 2^MAXBACKOFF, until the ECU answers again.
+#define VEHICLE_POLL_TIMEOUT            10
+#define VEHICLE_POLL_RETRIES            1
+#define VEHICLE_POLL_MAXBACKOFF         3
+
+// Statistics per poll list entry:
+typedef struct
+{
+  unsigned int req;           // requests sent
+  unsigned int resp;          // responses received
+  unsigned char timeouts;     // timeouts (saturating at 255)
+  unsigned char failcnt;      // consecutive timeouts
+  unsigned char latmin;       // response latency min [ms] (max 255)
+  unsigned char latavg;       // response latency moving average [ms]
+  unsigned char latmax;       // response latency max [ms]
+} vehicle_pollstat_t;
+
 extern unsigned char vehicle_poll_state;        // Current poll state
 extern rom vehicle_pid_t* vehicle_poll_plist;   // Head of poll list
 extern rom vehicle_pid_t* vehicle_poll_plcur;   // Current position in poll list
@@ -151,10 +390,55 @@ extern unsigned char vehicle_poll_busactive;    // Indicates recent activity on
 extern unsigned int vehicle_poll_ml_remain;     // Bytes remaining for vehicle poll
 extern unsigned int vehicle_poll_ml_offset;     // Offset of vehicle poll data
 extern unsigned int vehicle_poll_ml_frame;      // Frame number for vehicle poll
+extern unsigned int vehicle_poll_ml_errors;     // Multi frame sequence errors
+extern unsigned int vehicle_poll_ml_timeouts;   // Multi frame reception timeouts
+extern vehicle_pollstat_t vehicle_poll_stats[VEHICLE_POLL_MAXPIDS];
+
+// Scheduling delay statistics per poll state (seconds late vs. due time):
+extern unsigned char vehicle_poll_latemax[VEHICLE_POLL_NSTATES];
+extern unsigned int vehicle_poll_latesum[VEHICLE_POLL_NSTATES];
+extern unsigned int vehicle_poll_latecnt[VEHICLE_POLL_NSTATES];
 
 void vehicle_poll_setpidlist(rom vehicle_pid_t *plist);
 void vehicle_poll_setstate(unsigned char state);
 
+// Poll list configuration (EEPROM, PARAM_POLLCFG):
+// overrides the enable state and poll periods of the first
+// VEHICLE_POLLCFG_MAX entries of the rom poll list at runtime.
+// The config only applies to the list it was written for (checksum).
+#ifdef OVMS_ACCMODULE
+#error "OVMS_POLLER: PARAM_POLLCFG uses the ACC param slots"
+#endif
+
+#define VEHICLE_POLLCFG_MAX             15
+#define VEHICLE_POLLCFG_MAGIC           0x50 // 'P'
+#define VEHICLE_POLLCFG_OFF             0x01 // flags: entry disabled
+#define VEHICLE_POLLCFG_DEFAULT         0xff // polltime: use poll list value
+
+typedef struct
+{
+  unsigned char flags;
+  unsigned char polltime[VEHICLE_POLL_NSTATES]; // seconds (max 254)
+} vehicle_pollcfg_entry_t;
+
+typedef struct
+{
+  unsigned char magic;        // VEHICLE_POLLCFG_MAGIC
+  unsigned char count;        // number of poll list entries
+  unsigned int listsum;       // poll list checksum
+  vehicle_pollcfg_entry_t entry[VEHICLE_POLLCFG_MAX];
+} vehicle_pollcfg_t;          // 64 bytes = 2 param slots
+
+extern vehicle_pollcfg_t vehicle_pollcfg;
+
+unsigned char vehicle_poll_count(void);
+BOOL vehicle_poll_isenabled(unsigned char idx);
+unsigned int vehicle_poll_cfgtime(unsigned char idx, unsigned char state);
+unsigned int vehicle_poll_gettime(unsigned char idx, unsigned char state);
+void vehicle_poll_setcfg(unsigned char idx, unsigned char flags, unsigned char *polltime);
+void vehicle_poll_resetcfg(void);
+unsigned char vehicle_poll_cfgcmd(char *arg);
+
 #endif //#ifdef OVMS_POLLER
 
 #endif // #ifndef __OVMS_VEHICLE_H
@@ -264,12 +264,16 @@ UINT8 ks_door_byte; //TODO Temporary door byte for analysis purposes
 //      unsigned char type; // see vehicle.h
 //      unsigned int pid; // the PID to request
 //      unsigned int polltime[VEHICLE_POLL_NSTATES]; // poll frequency
+//      unsigned char stmin; // ISO-TP separation time (optional)
+//      unsigned char bs; // ISO-TP block size (optional)
 //    } vehicle_pid_t;
 //
 // Polling types ("modes") supported: see vehicle.h
 // 
 // polltime[state] = poll period in seconds, i.e. 10 = poll every 10 seconds
 //
+// stmin/bs: see vehicle.h (default 50 ms / all frames)
+//
 // state: 0..2; set by vehicle_poll_setstate()
 //     0=off, 1=on, 2=charging
 //
@@ -280,11 +284,11 @@ rom vehicle_pid_t vehicle_kiasoul_polls[] = {
   { 0x7e4, 0x7ec, VEHICLE_POLL_TYPE_OBDIIGROUP, 0x01,
     { 30, 10, 10}}, // Diag page 01
   { 0x7e4, 0x7ec, VEHICLE_POLL_TYPE_OBDIIGROUP, 0x02,
-    { 0, 30, 10}}, // Diag page 02
+    { 0, 30, 10}, 5}, // Diag page 02 (cell data, 5 ms STmin)
   { 0x7e4, 0x7ec, VEHICLE_POLL_TYPE_OBDIIGROUP, 0x03,
-    { 0, 30, 10}}, // Diag page 03
+    { 0, 30, 10}, 5}, // Diag page 03 (cell data, 5 ms STmin)
   { 0x7e4, 0x7ec, VEHICLE_POLL_TYPE_OBDIIGROUP, 0x04,
-    { 0, 30, 10}}, // Diag page 04
+    { 0, 30, 10}, 5}, // Diag page 04 (cell data, 5 ms STmin)
   { 0x7e4, 0x7ec, VEHICLE_POLL_TYPE_OBDIIGROUP, 0x05,
     { 120, 10, 10}}, // Diag page 05
 
@@ -303,7 +307,9 @@ rom vehicle_pid_t vehicle_kiasoul_polls[] = {
 };
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_kiasoul_checkpass(char *password)
 {
@@ -724,7 +730,9 @@ BOOL vehicle_kiasoul_poll1(void) {
   return TRUE;
 }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 ////////////////////////////////////////////////////////////////////////
 // vehicle_Kia Soul EV get_maxrange: get MAXRANGE with temperature compensation
@@ -1028,38 +1036,14 @@ BOOL vehicle_kiasoul_ticker1(void) {
 void vehicle_kiasoul_send_can_message(void)
 {
   if( sys_features[FEATURE_CANWRITE]>0 ){
-    // wait for previous async send (if any) to finish:
-    while (TXB0CONbits.TXREQ) {}
-
     // try to prevent bus flooding:
     delay5b();
 
-    // init transmit:
-    TXB0CON = 0;
-
-    TXB0SIDL = (ks_send_can.id & 0x07) << 5;
-    TXB0SIDH = (ks_send_can.id >> 3);
-
-    // fill in the can message
-    TXB0D0 = ks_send_can.byte[0];
-    TXB0D1 = ks_send_can.byte[1];
-    TXB0D2 = ks_send_can.byte[2];
-    TXB0D3 = ks_send_can.byte[3];
-    TXB0D4 = ks_send_can.byte[4];
-    TXB0D5 = ks_send_can.byte[5];
-    TXB0D6 = ks_send_can.byte[6];
-    TXB0D7 = ks_send_can.byte[7];
-
-    // data length (8):
-    TXB0DLC = 0b00001000;
-
     // clear status to detect reply:
     ks_send_can.status = 0xff;
 
     // send:
-    TXB0CON = 0b00001000;
-
-    while (TXB0CONbits.TXREQ) {}
+    vehicle_can_tx(ks_send_can.id, VEHICLE_TXPRI_NORMAL, 8, ks_send_can.byte);
   }
 }
 
@@ -1087,6 +1071,10 @@ BOOL vehicle_kiasoul_send_can_message_sync(UINT16 id, UINT8 count,
   timeout = 200; // ~1000 ms
   do {
     delay5b();
+#ifdef OVMS_CANRXQUEUE
+    // the reply is detected by poll1, which now runs from the queue:
+    vehicle_rxq_process();
+#endif
   } while (ks_send_can.status == 0xff && --timeout);
  
   if(timeout != 0 ){
@@ -1688,21 +1676,20 @@ rom far BOOL(*vehicle_kiasoul_sms_hfntable[])(BOOL premsg, char *caller, char *c
 BOOL vehicle_kiasoul_fn_smshandler(BOOL premsg, char *caller, char *command, char *arguments) {
   // called to extend/replace standard command: framework did auth check for us
 
-  UINT8 k;
+  signed char k;
 
   // Command parsing...
-  for (k = 0; vehicle_kiasoul_sms_cmdtable[k][0] != 0; k++) {
-    if (starts_with(command, (char const rom far*) vehicle_kiasoul_sms_cmdtable[k] + 1)) {
-      // Call sms handler:
-      k = (*vehicle_kiasoul_sms_hfntable[k])(premsg, caller, command, arguments);
-
-      if ((premsg) && (k)) {
-        // we're in charge + handled it; finish SMS:
-        net_send_sms_finish();
-      }
-
-      return k;
+  k = net_sms_findcmd((char const rom far*) vehicle_kiasoul_sms_cmdtable, command);
+  if (k >= 0) {
+    // Call sms handler:
+    k = (*vehicle_kiasoul_sms_hfntable[k])(premsg, caller, command, arguments);
+
+    if ((premsg) && (k)) {
+      // we're in charge + handled it; finish SMS:
+      net_send_sms_finish();
     }
+
+    return k;
   }
 
   return FALSE; // no vehicle command
@@ -1711,26 +1698,25 @@ BOOL vehicle_kiasoul_fn_smshandler(BOOL premsg, char *caller, char *command, cha
 BOOL vehicle_kiasoul_fn_smsextensions(char *caller, char *command, char *arguments) {
   // called for specific command: we need to do the auth check
 
-  UINT8 k;
+  signed char k;
 
   // Command parsing...
-  for (k = 0; vehicle_kiasoul_sms_cmdtable[k][0] != 0; k++) {
-    if (starts_with(command, (char const rom far*) vehicle_kiasoul_sms_cmdtable[k] + 1)) {
-      // we need to check the caller authorization:
-      arguments = net_sms_initargs(arguments);
-      if (!net_sms_checkauth(vehicle_kiasoul_sms_cmdtable[k][0], caller, &arguments))
-        return FALSE; // failed
-
-      // Call sms handler:
-      k = (*vehicle_kiasoul_sms_hfntable[k])(TRUE, caller, command, arguments);
-
-      if (k) {
-        // we're in charge + handled it; finish SMS:
-        net_send_sms_finish();
-      }
-
-      return k;
+  k = net_sms_findcmd((char const rom far*) vehicle_kiasoul_sms_cmdtable, command);
+  if (k >= 0) {
+    // we need to check the caller authorization:
+    arguments = net_sms_initargs(arguments);
+    if (!net_sms_checkauth(vehicle_kiasoul_sms_cmdtable[k][0], caller, &arguments))
+      return FALSE; // failed
+
+    // Call sms handler:
+    k = (*vehicle_kiasoul_sms_hfntable[k])(TRUE, caller, command, arguments);
+
+    if (k) {
+      // we're in charge + handled it; finish SMS:
+      net_send_sms_finish();
     }
+
+    return k;
   }
 
   return FALSE; // no vehicle command
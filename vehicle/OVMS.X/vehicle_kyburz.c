@@ -157,7 +157,9 @@ BOOL vehicle_kyburz_ticker1(void)
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_kyburz_poll0(void)
   {
@@ -211,7 +213,9 @@ BOOL vehicle_kyburz_poll0(void)
   return TRUE;
   }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -376,7 +376,9 @@ BOOL vehicle_mitsubishi_ticker10(void)
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_mitsubishi_poll0(void)
   {
@@ -528,7 +530,9 @@ BOOL vehicle_mitsubishi_poll1(void)
   return TRUE;
   }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 ////////////////////////////////////////////////////////////////////////
 // vehicle_mitsubishi_initialise()
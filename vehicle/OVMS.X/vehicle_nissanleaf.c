@@ -132,7 +132,9 @@ rom vehicle_pid_t vehicle_nissanleaf_polls[]
   };
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 ////////////////////////////////////////////////////////////////////////
 // vehicle_nissanleaf_send_can_message()
@@ -143,25 +145,11 @@ rom vehicle_pid_t vehicle_nissanleaf_polls[]
 
 void vehicle_nissanleaf_send_can_message(short id, unsigned char length, unsigned char *data)
   {
-  volatile far unsigned char *txb0 = &TXB0D0;
-  UINT8 i;
-
   if (sys_features[FEATURE_CANWRITE] == 0 || length > 8)
     {
     return;
     }
-  while (TXB0CONbits.TXREQ)
-    {
-    } // Loop until TX is done
-  TXB0CON = 0;
-  TXB0SIDL = (id & 0x7) << 5;
-  TXB0SIDH = id >> 3;
-  for (i = 0; i < length; i++)
-    {
-    txb0[i] = data[i];
-    }
-  TXB0DLC = length; // data length
-  TXB0CON = 0b00001000; // mark for transmission
+  vehicle_can_tx(id, VEHICLE_TXPRI_NORMAL, length, data);
   }
 
 ////////////////////////////////////////////////////////////////////////
@@ -186,7 +174,7 @@ BOOL vehicle_nissanleaf_poll0(void)
         car_vin[value1 + (vehicle_poll_ml_offset - can_datalength)] = can_databuffer[value1];
         }
       if (vehicle_poll_ml_remain == 0)
-        car_vin[value1 + vehicle_poll_ml_offset] = 0;
+        car_vin[(vehicle_poll_ml_offset < 17) ? vehicle_poll_ml_offset : 17] = 0;
       break;
     case 0x0d: // Speed
       if (can_mileskm == 'K')
@@ -509,7 +497,9 @@ BOOL vehicle_nissanleaf_poll1(void)
   return TRUE;
   }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 ////////////////////////////////////////////////////////////////////////
 // vehicle_nissanleaf_remote_command()
@@ -51,7 +51,8 @@ rom  vehicle_pid_t vehicle_obdii_polls[]
     { 0x7df, 0, VEHICLE_POLL_TYPE_OBDIICURRENT, 0x2f, {  0, 30, 30 } }, // Fuel level
     { 0x7df, 0, VEHICLE_POLL_TYPE_OBDIICURRENT, 0x46, {  0, 30, 30 } }, // Ambiant temp
     { 0x7df, 0, VEHICLE_POLL_TYPE_OBDIICURRENT, 0x5c, {  0, 30, 30 } }, // Engine oil temp
-    { 0x7df, 0, VEHICLE_POLL_TYPE_OBDIIVEHICLE, 0x02, {999,999,999 } }, // VIN
+    { 0x7df, 0, VEHICLE_POLL_TYPE_OBDIIVEHICLE, 0x02, {999,999,999 },
+      0, 0, 0, car_vin, sizeof(car_vin)-1 }, // VIN
     { 0, 0, 0x00, 0x00, { 0, 0, 0 } }
   };
 
@@ -83,7 +84,9 @@ BOOL vehicle_obdii_ticker1(void)
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_obdii_poll0(void)
   {
@@ -95,13 +98,8 @@ BOOL vehicle_obdii_poll0(void)
   
   switch (vehicle_poll_pid)
     {
-    case 0x02:  // VIN (multi-line response)
-      for (value1=0;value1<can_datalength;value1++)
-        {
-        car_vin[value1+(vehicle_poll_ml_offset-can_datalength)] = can_databuffer[value1];
-        }
-      if (vehicle_poll_ml_remain==0)
-        car_vin[value1+vehicle_poll_ml_offset] = 0;
+    case 0x02:  // VIN (multi-line response, reassembled in car_vin)
+      car_vin[(vehicle_poll_ml_offset < 17) ? vehicle_poll_ml_offset : 17] = 0;
       break;
     case 0x05:  // Engine coolant temperature
       car_stale_temps = 60;
@@ -158,7 +156,9 @@ BOOL vehicle_obdii_poll0(void)
   return TRUE;
   }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -172,7 +172,9 @@ BOOL vehicle_tazzari_ticker1(void)
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_tazzari_poll0(void)
   {
@@ -288,7 +290,9 @@ BOOL vehicle_tazzari_poll1(void)
   return TRUE;
   }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -69,335 +69,375 @@ BOOL vehicle_teslaroadster_ticker60(void);
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
-BOOL vehicle_teslaroadster_poll0(void)                // CAN ID 100 and 102
+BOOL vehicle_teslaroadster_rx100(void)
   {
   unsigned char k;
   unsigned int k1;
   unsigned long k2;
 
-  if (can_id == 0x100)
+  switch (can_databuffer[0])
     {
-    switch (can_databuffer[0])
-      {
-      case 0x06: // Charge timer mode
-        if (can_databuffer[1] == 0x1b)
-          {
-          car_timermode = can_databuffer[4];
-          car_stale_timer = 1; // Reset stale indicator
-          }
-        else if (can_databuffer[1] == 0x1a)
-          {
-          car_timerstart = (can_databuffer[4]<<8)+can_databuffer[5];
-          car_stale_timer = 1; // Reset stale indicator
-          }
-        break;
-      case 0x80: // Range / State of Charge
-        car_SOC = can_databuffer[1];
-        car_idealrange = can_databuffer[2]+((unsigned int) can_databuffer[3] << 8);
-        car_estrange = can_databuffer[6]+((unsigned int) can_databuffer[7] << 8);
-        if (car_idealrange>6000) car_idealrange=0; // Sanity check (limit rng->std)
-        if (car_estrange>6000)   car_estrange=0; // Sanity check (limit rng->std)
-        break;
-      case 0x81: // Time/ Date UTC
-        car_time = can_databuffer[4]
-                   + ((unsigned long) can_databuffer[5] << 8)
-                   + ((unsigned long) can_databuffer[6] << 16)
-                   + ((unsigned long) can_databuffer[7] << 24);
-        break;
-      case 0x82: // Ambient Temperature
-        car_ambient_temp = (signed char)can_databuffer[1];
-        car_stale_ambient = 120; // Reset stale indicator
-        break;
-      case 0x83: // GPS Latitude
-        car_latitude = can_databuffer[4]
-                       + ((unsigned long) can_databuffer[5] << 8)
-                       + ((unsigned long) can_databuffer[6] << 16)
-                       + ((unsigned long) can_databuffer[7] << 24);
-        break;
-      case 0x84: // GPS Longitude
-        car_longitude = can_databuffer[4]
-                        + ((unsigned long) can_databuffer[5] << 8)
-                        + ((unsigned long) can_databuffer[6] << 16)
-                        + ((unsigned long) can_databuffer[7] << 24);
-        break;
-      case 0x85: // GPS direction and altitude
-        car_gpslock = can_databuffer[1];
-        if (car_gpslock)
-          {
-          car_direction = ((unsigned int)can_databuffer[3]<<8)+(can_databuffer[2]);
-          if (car_direction==360) car_direction=0; // Bug-fix for Tesla VMS bug
-          if (can_databuffer[5]&0xf0)
-            car_altitude = 0;
-          else
-            car_altitude = ((unsigned int)can_databuffer[5]<<8)+(can_databuffer[4]);
-          car_stale_gps = 120; // Reset stale indicator
-          }
-        else
-          {
-          car_stale_gps = 0; // Reset stale indicator
-          }
-        break;
-      case 0x88: // Charging Current / Duration
-        if (can_databuffer[6] != car_chargelimit)
-          { // If the charge limit has changed, notify it
-          net_req_notification(NET_NOTIFY_STAT);
-          }
-        car_chargecurrent = can_databuffer[1];
-        car_chargelimit = can_databuffer[6];
-        car_chargeduration = ((unsigned int)can_databuffer[3]<<8)+(can_databuffer[2]);
-        break;
-      case 0x89: // Charging Voltage / Iavailable
-        if (can_mileskm=='M')
-          car_speed = can_databuffer[1];     // speed in miles/hour
+    case 0x06: // Charge timer mode
+      if (can_databuffer[1] == 0x1b)
+        {
+        car_timermode = can_databuffer[4];
+        car_stale_timer = 1; // Reset stale indicator
+        }
+      else if (can_databuffer[1] == 0x1a)
+        {
+        car_timerstart = (can_databuffer[4]<<8)+can_databuffer[5];
+        car_stale_timer = 1; // Reset stale indicator
+        }
+      break;
+    case 0x80: // Range / State of Charge
+      car_SOC = can_databuffer[1];
+      car_idealrange = can_databuffer[2]+((unsigned int) can_databuffer[3] << 8);
+      car_estrange = can_databuffer[6]+((unsigned int) can_databuffer[7] << 8);
+      if (car_idealrange>6000) car_idealrange=0; // Sanity check (limit rng->std)
+      if (car_estrange>6000)   car_estrange=0; // Sanity check (limit rng->std)
+      break;
+    case 0x81: // Time/ Date UTC
+      car_time = can_databuffer[4]
+                 + ((unsigned long) can_databuffer[5] << 8)
+                 + ((unsigned long) can_databuffer[6] << 16)
+                 + ((unsigned long) can_databuffer[7] << 24);
+      break;
+    case 0x82: // Ambient Temperature
+      car_ambient_temp = (signed char)can_databuffer[1];
+      car_stale_ambient = 120; // Reset stale indicator
+      break;
+    case 0x83: // GPS Latitude
+      car_latitude = can_databuffer[4]
+                     + ((unsigned long) can_databuffer[5] << 8)
+                     + ((unsigned long) can_databuffer[6] << 16)
+                     + ((unsigned long) can_databuffer[7] << 24);
+      break;
+    case 0x84: // GPS Longitude
+      car_longitude = can_databuffer[4]
+                      + ((unsigned long) can_databuffer[5] << 8)
+                      + ((unsigned long) can_databuffer[6] << 16)
+                      + ((unsigned long) can_databuffer[7] << 24);
+      break;
+    case 0x85: // GPS direction and altitude
+      car_gpslock = can_databuffer[1];
+      if (car_gpslock)
+        {
+        car_direction = ((unsigned int)can_databuffer[3]<<8)+(can_databuffer[2]);
+        if (car_direction==360) car_direction=0; // Bug-fix for Tesla VMS bug
+        if (can_databuffer[5]&0xf0)
+          car_altitude = 0;
         else
-          car_speed = (unsigned char) ((((unsigned long)can_databuffer[1] * 1609)+500)/1000);     // speed in km/hour
-        car_linevoltage = can_databuffer[2]
-                          + ((unsigned int) can_databuffer[3] << 8);
-        break;
-      case 0x93: // VDS Vehicle Error
-        k = can_databuffer[1];
-        k1 = ((unsigned int)can_databuffer[3]<<8)+(can_databuffer[2]);
-        k2 = (((unsigned long)can_databuffer[7]<<24) +
-              ((unsigned long)can_databuffer[6]<<16) +
-              ((unsigned long)can_databuffer[5]<<8) +
-              (can_databuffer[4]));
-        if (k1 != 0xffff)
+          car_altitude = ((unsigned int)can_databuffer[5]<<8)+(can_databuffer[4]);
+        car_stale_gps = 120; // Reset stale indicator
+        }
+      else
+        {
+        car_stale_gps = 0; // Reset stale indicator
+        }
+      break;
+    case 0x88: // Charging Current / Duration
+      if (can_databuffer[6] != car_chargelimit)
+        { // If the charge limit has changed, notify it
+        net_req_notification(NET_NOTIFY_STAT);
+        }
+      car_chargecurrent = can_databuffer[1];
+      car_chargelimit = can_databuffer[6];
+      car_chargeduration = ((unsigned int)can_databuffer[3]<<8)+(can_databuffer[2]);
+      break;
+    case 0x89: // Charging Voltage / Iavailable
+      if (can_mileskm=='M')
+        car_speed = can_databuffer[1];     // speed in miles/hour
+      else
+        car_speed = (unsigned char) ((((unsigned long)can_databuffer[1] * 1609)+500)/1000);     // speed in km/hour
+      car_linevoltage = can_databuffer[2]
+                        + ((unsigned int) can_databuffer[3] << 8);
+      break;
+    case 0x93: // VDS Vehicle Error
+      k = can_databuffer[1];
+      k1 = ((unsigned int)can_databuffer[3]<<8)+(can_databuffer[2]);
+      k2 = (((unsigned long)can_databuffer[7]<<24) +
+            ((unsigned long)can_databuffer[6]<<16) +
+            ((unsigned long)can_databuffer[5]<<8) +
+            (can_databuffer[4]));
+      if (k1 != 0xffff)
+        {
+        if ((k == 0x14)&&(k1 == 25))
           {
-          if ((k == 0x14)&&(k1 == 25))
-            {
-            // Special case of 100% vehicle logs
-            net_req_notification_error(0, 0);
-            net_req_notification_error(k1, k2); // Notify the 100%
-            }
-          else if (k & 0x01)
-            {
-            // An error code is being raised
-            net_req_notification_error(k1, k2);
-            }
-          else
-            {
-            // An error code is being cleared
-            net_req_notification_error(0, 0);
-            }
+          // Special case of 100% vehicle logs
+          net_req_notification_error(0, 0);
+          net_req_notification_error(k1, k2); // Notify the 100%
           }
-        break;
-      case 0x8F: // HVAC#1 message
-        k1 = ((unsigned int)can_databuffer[7]<<8)+(can_databuffer[6]);
-        if (k1 > 0)
+        else if (k & 0x01)
           {
-          car_doors5bits.HVAC = 1;
-          tr_cooldown_recycle = -1;  // Stop the recycle attempts
+          // An error code is being raised
+          net_req_notification_error(k1, k2);
           }
         else
           {
-          if ((car_coolingdown>=0)&&(car_doors5bits.HVAC))
-            {
-            // Car is cooling down, and HVAC has just gone off - end of a cycle
-            car_coolingdown++;
-            tr_cooldown_recycle = 60;  // Try to recycle cooling in 60 seconds
-            net_req_notification(NET_NOTIFY_STAT);
-            }
-          car_doors5bits.HVAC = 0;
+          // An error code is being cleared
+          net_req_notification_error(0, 0);
           }
-        break;
-      case 0x95: // Charging mode
-        if ((can_databuffer[1] != car_chargestate)&&            // Charge state has changed AND
-            ((car_chargestate<=2)||(car_chargestate==0x0f))&&   // was (Charging or Heating) AND
-            (can_databuffer[1]!=0x04))                          // new state is not done
+        }
+      break;
+    case 0x8F: // HVAC#1 message
+      k1 = ((unsigned int)can_databuffer[7]<<8)+(can_databuffer[6]);
+      if (k1 > 0)
+        {
+        car_doors5bits.HVAC = 1;
+        tr_cooldown_recycle = -1;  // Stop the recycle attempts
+        }
+      else
+        {
+        if ((car_coolingdown>=0)&&(car_doors5bits.HVAC))
           {
-          // We've moved from charging/heating to something other than DONE
-          // Let's treat this as a notifiable alert
-          net_req_notification(NET_NOTIFY_CHARGE);
-          }
-        if ((can_databuffer[1] != car_chargestate)||
-            (can_databuffer[2] != car_chargesubstate))
-          { // If the state or sub-state has changed, notify it
+          // Car is cooling down, and HVAC has just gone off - end of a cycle
+          car_coolingdown++;
+          tr_cooldown_recycle = 60;  // Try to recycle cooling in 60 seconds
           net_req_notification(NET_NOTIFY_STAT);
-          if (can_databuffer[1]==1)
-            tr_requestcac=2; // Request CAC when charge starts
           }
-        car_chargestate = can_databuffer[1];
-        car_chargesubstate = can_databuffer[2];
-        if (sys_features[FEATURE_CARBITS]&FEATURE_CB_2008) // A 2010+ roadster?
-          k = (can_databuffer[4]) & 0x0F;  // for 2008 roadsters
-        else
-          k = (can_databuffer[5] >> 4) & 0x0F; // for 2010 roadsters
-        if (k != car_chargemode)
-          { // If the charge mode has changed, notify it
-          car_chargemode = k;
-          net_req_notification(NET_NOTIFY_STAT);
-          }
-        car_charge_b4 = can_databuffer[3];
-        car_chargekwh = ((UINT) can_databuffer[7]) * 10;
-        break;
-      case 0x96: // Doors / Charging yes/no
-        if (car_chargestate == 0x0f) can_databuffer[1] |= 0x10; // Fudge for heating state, to be charging=on
-        if ((car_doors1 != can_databuffer[1])||
-            (car_doors2 != can_databuffer[2])||
-            (car_doors3 != can_databuffer[3])||
-            (car_doors4 != can_databuffer[4]))
-          net_req_notification(NET_NOTIFY_ENV);
-
-        if (((car_doors2&0x80)==0)&&(can_databuffer[2]&0x80)&&(can_databuffer[2]&0x10))
-          net_req_notification(NET_NOTIFY_TRUNK); // Valet mode is active, and trunk was opened
-
-        if (((car_doors4&0x02)==0)&&((can_databuffer[4]&0x02)!=0))
-          net_req_notification(NET_NOTIFY_ALARM); // Alarm has been triggered
-
-        car_doors1 = can_databuffer[1]; // Doors #1
-        car_doors2 = can_databuffer[2]; // Doors #2
-        car_doors3 = can_databuffer[3]; // Doors #3
-        car_doors4 = can_databuffer[4]; // Doors #4
-        if (((car_doors1 & 0x80)==0)&&  // Car is not ON
-            (car_parktime == 0)&&       // Parktime was not previously set
-            (car_time != 0))            // We know the car time
-          {
-          tr_requestcac=2; // Request CAC when car stops
-          car_parktime = car_time-1;    // Record it as 1 second ago, so non zero report
-          net_req_notification(NET_NOTIFY_ENV);
-          }
-        else if ((car_doors1 & 0x80)&&  // Car is ON
-                 (car_parktime != 0))   // Parktime was previously set
-          {
-          tr_requestcac=2; // Request CAC when car starts
-          car_parktime = 0;
-          net_req_notification(NET_NOTIFY_ENV);
-          }
-        break;
-      case 0x9E: // CAC
-        if (tr_requestcac == 1)
-          tr_requestcac = 3; // Turn off CAC streaming
-        car_cac100 = ((unsigned int)can_databuffer[3]*100)+
-                     ((((unsigned int)can_databuffer[2]*100)+128)/256);
-        break;
-      case 0xA3: // Temperatures
-        car_tpem = (signed char)can_databuffer[1]; // Tpem
-        car_tmotor = (unsigned char)can_databuffer[2]; // Tmotor
-        car_tbattery = (signed char)can_databuffer[6]; // Tbattery
-        car_stale_temps = 120; // Reset stale indicator
-        break;
-      case 0xA4: // 7 VIN bytes i.e. "SFZRE2B"
-        for (k=0;k<7;k++)
-          car_vin[k] = can_databuffer[k+1];
-        break;
-      case 0xA5: // 7 VIN bytes i.e. "39A3000"
-        for (k=0;k<7;k++)
-          car_vin[k+7] = can_databuffer[k+1];
-        if ((can_databuffer[3] == 'A')||(can_databuffer[3] == 'B'))
-          car_type[2] = '2';
-        else
-          car_type[2] = '1';
-        if (can_databuffer[3] == '8')
-          sys_features[FEATURE_CARBITS] |= FEATURE_CB_2008; // Auto-enable 1.5 support
-        if (can_databuffer[1] == '3')
-          car_type[3] = 'S';
-        else
-          car_type[3] = 'N';
-        break;
-      case 0xA6: // 3 VIN bytes i.e. "359"
-        car_vin[14] = can_databuffer[1];
-        car_vin[15] = can_databuffer[2];
-        car_vin[16] = can_databuffer[3];
-        break;
-      }
+        car_doors5bits.HVAC = 0;
+        }
+      break;
+    case 0x95: // Charging mode
+      if ((can_databuffer[1] != car_chargestate)&&            // Charge state has changed AND
+          ((car_chargestate<=2)||(car_chargestate==0x0f))&&   // was (Charging or Heating) AND
+          (can_databuffer[1]!=0x04))                          // new state is not done
+        {
+        // We've moved from charging/heating to something other than DONE
+        // Let's treat this as a notifiable alert
+        net_req_notification(NET_NOTIFY_CHARGE);
+        }
+      if ((can_databuffer[1] != car_chargestate)||
+          (can_databuffer[2] != car_chargesubstate))
+        { // If the state or sub-state has changed, notify it
+        net_req_notification(NET_NOTIFY_STAT);
+        if (can_databuffer[1]==1)
+          tr_requestcac=2; // Request CAC when charge starts
+        }
+      car_chargestate = can_databuffer[1];
+      car_chargesubstate = can_databuffer[2];
+      if (sys_features[FEATURE_CARBITS]&FEATURE_CB_2008) // A 2010+ roadster?
+        k = (can_databuffer[4]) & 0x0F;  // for 2008 roadsters
+      else
+        k = (can_databuffer[5] >> 4) & 0x0F; // for 2010 roadsters
+      if (k != car_chargemode)
+        { // If the charge mode has changed, notify it
+        car_chargemode = k;
+        net_req_notification(NET_NOTIFY_STAT);
+        }
+      car_charge_b4 = can_databuffer[3];
+      car_chargekwh = ((UINT) can_databuffer[7]) * 10;
+      break;
+    case 0x96: // Doors / Charging yes/no
+      if (car_chargestate == 0x0f) can_databuffer[1] |= 0x10; // Fudge for heating state, to be charging=on
+      if ((car_doors1 != can_databuffer[1])||
+          (car_doors2 != can_databuffer[2])||
+          (car_doors3 != can_databuffer[3])||
+          (car_doors4 != can_databuffer[4]))
+        net_req_notification(NET_NOTIFY_ENV);
+
+      if (((car_doors2&0x80)==0)&&(can_databuffer[2]&0x80)&&(can_databuffer[2]&0x10))
+        net_req_notification(NET_NOTIFY_TRUNK); // Valet mode is active, and trunk was opened
+
+      if (((car_doors4&0x02)==0)&&((can_databuffer[4]&0x02)!=0))
+        net_req_notification(NET_NOTIFY_ALARM); // Alarm has been triggered
+
+      car_doors1 = can_databuffer[1]; // Doors #1
+      car_doors2 = can_databuffer[2]; // Doors #2
+      car_doors3 = can_databuffer[3]; // Doors #3
+      car_doors4 = can_databuffer[4]; // Doors #4
+      if (((car_doors1 & 0x80)==0)&&  // Car is not ON
+          (car_parktime == 0)&&       // Parktime was not previously set
+          (car_time != 0))            // We know the car time
+        {
+        tr_requestcac=2; // Request CAC when car stops
+        car_parktime = car_time-1;    // Record it as 1 second ago, so non zero report
+        net_req_notification(NET_NOTIFY_ENV);
+        }
+      else if ((car_doors1 & 0x80)&&  // Car is ON
+               (car_parktime != 0))   // Parktime was previously set
+        {
+        tr_requestcac=2; // Request CAC when car starts
+        car_parktime = 0;
+        net_req_notification(NET_NOTIFY_ENV);
+        }
+      break;
+    case 0x9E: // CAC
+      if (tr_requestcac == 1)
+        tr_requestcac = 3; // Turn off CAC streaming
+      car_cac100 = ((unsigned int)can_databuffer[3]*100)+
+                   ((((unsigned int)can_databuffer[2]*100)+128)/256);
+      break;
+    case 0xA3: // Temperatures
+      car_tpem = (signed char)can_databuffer[1]; // Tpem
+      car_tmotor = (unsigned char)can_databuffer[2]; // Tmotor
+      car_tbattery = (signed char)can_databuffer[6]; // Tbattery
+      car_stale_temps = 120; // Reset stale indicator
+      break;
+    case 0xA4: // 7 VIN bytes i.e. "SFZRE2B"
+      for (k=0;k<7;k++)
+        car_vin[k] = can_databuffer[k+1];
+      break;
+    case 0xA5: // 7 VIN bytes i.e. "39A3000"
+      for (k=0;k<7;k++)
+        car_vin[k+7] = can_databuffer[k+1];
+      if ((can_databuffer[3] == 'A')||(can_databuffer[3] == 'B'))
+        car_type[2] = '2';
+      else
+        car_type[2] = '1';
+      if (can_databuffer[3] == '8')
+        sys_features[FEATURE_CARBITS] |= FEATURE_CB_2008; // Auto-enable 1.5 support
+      if (can_databuffer[1] == '3')
+        car_type[3] = 'S';
+      else
+        car_type[3] = 'N';
+      break;
+    case 0xA6: // 3 VIN bytes i.e. "359"
+      car_vin[14] = can_databuffer[1];
+      car_vin[15] = can_databuffer[2];
+      car_vin[16] = can_databuffer[3];
+      break;
     }
-  else if (can_id == 0x102)
+
+  return TRUE;
+  }
+
+BOOL vehicle_teslaroadster_rx102(void)
+  {
+  switch (can_databuffer[0])
     {
-    switch (can_databuffer[0])
-      {
-      case 0x0E: // Lock/Unlock state on ID#102
-        if (car_lockstate != can_databuffer[1])
-          net_req_notification(NET_NOTIFY_ENV);
-        car_lockstate = can_databuffer[1];
-        break;
-      }
+    case 0x0E: // Lock/Unlock state on ID#102
+      if (car_lockstate != can_databuffer[1])
+        net_req_notification(NET_NOTIFY_ENV);
+      car_lockstate = can_databuffer[1];
+      break;
     }
 
   return TRUE;
   }
 
-BOOL vehicle_teslaroadster_poll1(void)                // CAN ID 344 and 402
-{
-  if (can_id == 0x400)
+BOOL vehicle_teslaroadster_rx344(void)
+  {
+  // TPMS code here
+  if (can_databuffer[3]>0) // front-right
     {
-    // Speedometer feature - replace Range->Dash with speed
-    if ((can_databuffer[0]==0x02)&&         // The SPEEDO AMPS message
-        (sys_features[FEATURE_OPTIN]&FEATURE_OI_SPEEDO)&& // Digital speedo
-        ((sys_features[FEATURE_CARBITS]&FEATURE_CB_2008)==0)&& // A 2010+ roadster?
-        (car_doors1 & 0x80)&&               // The car is on
-        (car_speed != can_databuffer[2])&&  // The speed != Amps
-        (sys_features[FEATURE_CANWRITE]>0)) // The CAN bus can be written to
-      {
-      can_lastspeedmsg[0] = can_databuffer[0];
-      can_lastspeedmsg[1] = can_databuffer[1];
-      can_lastspeedmsg[2] = car_speed;
-      can_lastspeedmsg[3] = can_databuffer[3] & 0xf0; // Mask lower nibble (speed always <256)
-      can_lastspeedmsg[4] = can_databuffer[4];
-      can_lastspeedmsg[5] = can_databuffer[5];
-      can_lastspeedmsg[6] = can_databuffer[6];
-      can_lastspeedmsg[7] = can_databuffer[7];
-      while (TXB0CONbits.TXREQ) {} // Loop until TX is done
-      TXB0CON = 0;
-      TXB0SIDL = 0b00000000; // Setup Filter and Mask so that only CAN ID 0x100 will be accepted
-      TXB0SIDH = 0b10000000; // Set Filter to 0x400
-      TXB0D0 = can_lastspeedmsg[0];
-      TXB0D1 = can_lastspeedmsg[1];
-      TXB0D2 = can_lastspeedmsg[2];
-      TXB0D3 = can_lastspeedmsg[3];
-      TXB0D4 = can_lastspeedmsg[4];
-      TXB0D5 = can_lastspeedmsg[5];
-      TXB0D6 = can_lastspeedmsg[6];
-      TXB0D7 = can_lastspeedmsg[7];
-      TXB0DLC = 0b00001000; // data length (8)
-      TXB0CON = 0b00001000; // mark for transmission
-      can_lastspeedrpt = FEATURE_SPEEDO_REPEATS; // Force re-transmissions
-      if (can_lastspeedrpt>10) can_lastspeedrpt=10;
-      }
+    car_tpms_p[0] = can_databuffer[2];
+    car_tpms_t[0] = (signed char)can_databuffer[3];
     }
-  else if (can_id == 0x344)
+  if (can_databuffer[7]>0) // rear-right
     {
-    // TPMS code here
-    if (can_databuffer[3]>0) // front-right
-      {
-      car_tpms_p[0] = can_databuffer[2];
-      car_tpms_t[0] = (signed char)can_databuffer[3];
-      }
-    if (can_databuffer[7]>0) // rear-right
-      {
-      car_tpms_p[1] = can_databuffer[6];
-      car_tpms_t[1] = (signed char)can_databuffer[7];
-      }
-    if (can_databuffer[1]>0) // front-left
-      {
-      car_tpms_p[2] = can_databuffer[0];
-      car_tpms_t[2] = (signed char)can_databuffer[1];
-      }
-    if (can_databuffer[5]>0)
-      {
-      car_tpms_p[3] = can_databuffer[4];
-      car_tpms_t[3] = (signed char)can_databuffer[5];
-      }
-    car_stale_tpms = 120; // Reset stale indicator
+    car_tpms_p[1] = can_databuffer[6];
+    car_tpms_t[1] = (signed char)can_databuffer[7];
     }
-  else if (can_id == 0x402)
+  if (can_databuffer[1]>0) // front-left
     {
-    switch (can_databuffer[0])
-      {
-      case 0xFA:			// ODOMETER
-        car_odometer = can_databuffer[3]
+    car_tpms_p[2] = can_databuffer[0];
+    car_tpms_t[2] = (signed char)can_databuffer[1];
+    }
+  if (can_databuffer[5]>0)
+    {
+    car_tpms_p[3] = can_databuffer[4];
+    car_tpms_t[3] = (signed char)can_databuffer[5];
+    }
+  car_stale_tpms = 120; // Reset stale indicator
+
+  return TRUE;
+  }
+
+BOOL vehicle_teslaroadster_rx400(void)
+  {
+  // Speedometer feature - replace Range->Dash with speed
+  if ((can_databuffer[0]==0x02)&&         // The SPEEDO AMPS message
+      (sys_features[FEATURE_OPTIN]&FEATURE_OI_SPEEDO)&& // Digital speedo
+      ((sys_features[FEATURE_CARBITS]&FEATURE_CB_2008)==0)&& // A 2010+ roadster?
+      (car_doors1 & 0x80)&&               // The car is on
+      (car_speed != can_databuffer[2])&&  // The speed != Amps
+      (sys_features[FEATURE_CANWRITE]>0)) // The CAN bus can be written to
+    {
+    can_lastspeedmsg[0] = can_databuffer[0];
+    can_lastspeedmsg[1] = can_databuffer[1];
+    can_lastspeedmsg[2] = car_speed;
+    can_lastspeedmsg[3] = can_databuffer[3] & 0xf0; // Mask lower nibble (speed always <256)
+    can_lastspeedmsg[4] = can_databuffer[4];
+    can_lastspeedmsg[5] = can_databuffer[5];
+    can_lastspeedmsg[6] = can_databuffer[6];
+    can_lastspeedmsg[7] = can_databuffer[7];
+    while (TXB0CONbits.TXREQ) {} // Loop until TX is done
+    TXB0CON = 0;
+    TXB0SIDL = 0b00000000; // Setup Filter and Mask so that only CAN ID 0x100 will be accepted
+    TXB0SIDH = 0b10000000; // Set Filter to 0x400
+    TXB0D0 = can_lastspeedmsg[0];
+    TXB0D1 = can_lastspeedmsg[1];
+    TXB0D2 = can_lastspeedmsg[2];
+    TXB0D3 = can_lastspeedmsg[3];
+    TXB0D4 = can_lastspeedmsg[4];
+    TXB0D5 = can_lastspeedmsg[5];
+    TXB0D6 = can_lastspeedmsg[6];
+    TXB0D7 = can_lastspeedmsg[7];
+    TXB0DLC = 0b00001000; // data length (8)
+    TXB0CON = 0b00001000; // mark for transmission
+    can_lastspeedrpt = FEATURE_SPEEDO_REPEATS; // Force re-transmissions
+    if (can_lastspeedrpt>10) can_lastspeedrpt=10;
+    }
+
+  return TRUE;
+  }
+
+BOOL vehicle_teslaroadster_rx402(void)
+  {
+  switch (can_databuffer[0])
+    {
+    case 0xFA:			// ODOMETER
+      car_odometer = can_databuffer[3]
 		+ ((unsigned long) can_databuffer[4] << 8)
-                + ((unsigned long) can_databuffer[5] << 16);		// Miles /10
+              + ((unsigned long) can_databuffer[5] << 16);		// Miles /10
 	car_trip = can_databuffer[6] + ((unsigned int) can_databuffer[7] << 8);	// Miles /10
 	break;
-      }
     }
 
   return TRUE;
-}
+  }
 
+// CAN ID table, sorted by ID. This defines the RX filters, so all IDs
+// handled by vehicle_teslaroadster_poll() need to be listed here:
+rom vehicle_canid_t vehicle_teslaroadster_canids[] =
+  {
+  { 0, 0x100 },
+  { 0, 0x102 },
+  { 1, 0x344 },
+  { 1, 0x400 },
+  { 1, 0x402 }
+  };
+
+#define TR_CANIDS (sizeof(vehicle_teslaroadster_canids)/sizeof(vehicle_canid_t))
+
+#ifdef OVMS_CANCACHE
+// IDs decoded only on payload change (see vehicle_cancache_check):
+// 0x100/0x102/0x402 are multiplexed by byte 0, 0x400 feeds the speedo
+rom unsigned int vehicle_teslaroadster_cancache[] = { 0x344, 0 };
+#endif //#ifdef OVMS_CANCACHE
+
+BOOL vehicle_teslaroadster_poll(void)                 // RX buffers 0 + 1
+  {
+  switch (can_id)
+    {
+    case 0x100: return vehicle_teslaroadster_rx100();
+    case 0x102: return vehicle_teslaroadster_rx102();
+    case 0x344: return vehicle_teslaroadster_rx344();
+    case 0x400: return vehicle_teslaroadster_rx400();
+    case 0x402: return vehicle_teslaroadster_rx402();
+    }
+
+  return TRUE;
+  }
+
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -1279,19 +1319,11 @@ void vehicle_teslaroadster_initialise(void)
 
   // We are now in Configuration Mode
   
-  // RX buffer0 uses Mask RXM0 and filters RXF0, RXF1
+  // RX buffer0 uses Mask RXM0 and filters RXF0, RXF1 (0x100, 0x102)
+  // RX buffer1 uses Mask RXM1 and filters RXF2, RXF3, RXF4, RXF5 (0x344, 0x400, 0x402)
   RXB0CON = 0b00000000;
-  RXM0SIDH = 0b11111111; RXM0SIDL = 0b10100000; // Msk0 111 1111 1101 (0x7fd)
-  RXF0SIDH = 0b00100000; RXF0SIDL = 0b00000000; // Flt0 001 0000 00x0 (0x100 and 0x102 will be accepted)
-  RXF1SIDH = 0b00000000; RXF1SIDL = 0b00000000; // Flt1 000 0000 00x0 (-)
-
-  // RX buffer1 uses Mask RXM1 and filters RXF2, RXF3, RXF4, RXF5
   RXB1CON = 0b00000000;
-  RXM1SIDH = 0b11111111; RXM1SIDL = 0b11100000; // Msk1 111 1111 1111 (0x7ff)
-  RXF2SIDH = 0b01101000; RXF2SIDL = 0b10000000; // Flt2 011 0100 0100 (0x344)
-  RXF3SIDH = 0b10000000; RXF3SIDL = 0b01000000; // Flt3 100 0000 0010 (0x402)
-  RXF4SIDH = 0b10000000; RXF4SIDL = 0b00000000; // Flt4 100 0000 0000 (0x400)
-  RXF5SIDH = 0b00000000; RXF5SIDL = 0b00000000; // Flt5 000 0000 0000 (-)
+  vehicle_can_setfilters(vehicle_teslaroadster_canids, TR_CANIDS);
   
   BRGCON1 = 0; // SET BAUDRATE to 1 Mbps
   BRGCON2 = 0xD2;
@@ -1317,12 +1349,15 @@ void vehicle_teslaroadster_initialise(void)
 
   // Hook in...
   can_capabilities = teslaroadster_capabilities;
-  vehicle_fn_poll0 = &vehicle_teslaroadster_poll0;
-  vehicle_fn_poll1 = &vehicle_teslaroadster_poll1;
+  vehicle_fn_poll0 = &vehicle_teslaroadster_poll;
+  vehicle_fn_poll1 = &vehicle_teslaroadster_poll;
   vehicle_fn_ticker10th = &vehicle_teslaroadster_ticker10th;
   vehicle_fn_ticker1 = &vehicle_teslaroadster_ticker1;
   vehicle_fn_ticker60 = &vehicle_teslaroadster_ticker60;
   vehicle_fn_idlepoll = &vehicle_teslaroadster_idlepoll;
   vehicle_fn_commandhandler = &vehicle_teslaroadster_commandhandler;
   vehicle_fn_minutestocharge = &vehicle_teslaroadster_minutestocharge;
+#ifdef OVMS_CANCACHE
+  vehicle_cancache_setids(vehicle_teslaroadster_cancache);
+#endif //#ifdef OVMS_CANCACHE
   }
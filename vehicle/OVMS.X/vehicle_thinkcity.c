@@ -366,7 +366,9 @@ if ((tc_bit_chrgen == 0) && (tc_bit_dischgenbl == 0)) // Is charge_enable_bit (b
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_thinkcity_poll0(void)
   {
@@ -503,7 +505,9 @@ BOOL vehicle_thinkcity_poll1(void)
   return TRUE;
   }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -1007,36 +1011,32 @@ rom far BOOL(*vehicle_thinkcity_sms_hfntable[])(BOOL premsg, char *caller, char
 
 BOOL vehicle_thinkcity_fn_sms(BOOL checkauth, BOOL premsg, char *caller, char *command, char *arguments)
 {
-  int k;
+  signed char k;
 
   // Command parsing...
-  for (k = 0; vehicle_thinkcity_sms_cmdtable[k][0] != 0; k++)
+  k = net_sms_findcmd((char const rom far*)vehicle_thinkcity_sms_cmdtable, command);
+  if (k >= 0)
   {
-    if (memcmppgm2ram(command,
-                      (char const rom far*)vehicle_thinkcity_sms_cmdtable[k] + 1,
-                      strlenpgm((char const rom far*)vehicle_thinkcity_sms_cmdtable[k]) - 1) == 0)
-    {
-      BOOL result;
-
-      if (checkauth)
-      {
-        // we need to check the caller authorization:
-        arguments = net_sms_initargs(arguments);
-        if (!net_sms_checkauth(vehicle_thinkcity_sms_cmdtable[k][0], caller, &arguments))
-          return FALSE; // failed
-      }
+    BOOL result;
 
-      // Call sms handler:
-      result = (*vehicle_thinkcity_sms_hfntable[k])(premsg, caller, command, arguments);
+    if (checkauth)
+    {
+      // we need to check the caller authorization:
+      arguments = net_sms_initargs(arguments);
+      if (!net_sms_checkauth(vehicle_thinkcity_sms_cmdtable[k][0], caller, &arguments))
+        return FALSE; // failed
+    }
 
-      if ((premsg) && (result))
-      {
-        // we're in charge + handled it; finish SMS:
-        net_send_sms_finish();
-      }
+    // Call sms handler:
+    result = (*vehicle_thinkcity_sms_hfntable[k])(premsg, caller, command, arguments);
 
-      return result;
+    if ((premsg) && (result))
+    {
+      // we're in charge + handled it; finish SMS:
+      net_send_sms_finish();
     }
+
+    return result;
   }
 
   return FALSE; // no vehicle command
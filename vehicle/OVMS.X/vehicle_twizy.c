@@ -446,6 +446,10 @@ typedef struct {
 #define PARAM_PROFILE2              0x12 // custom profile #2 (binary, 2 slots)
 #define PARAM_PROFILE3              0x14 // custom profile #3 (binary, 2 slots)
 
+#if defined(OVMS_TWIZY_CFG) && defined(OVMS_POLLER)
+#error "OVMS_TWIZY_CFG: PARAM_PROFILE1 uses the PARAM_POLLCFG slots of OVMS_POLLER"
+#endif
+
 
 // Twizy specific commands:
 #define CMD_Debug                   200 // ()
@@ -1065,6 +1069,10 @@ UINT vehicle_twizy_sendsdoreq_sync(void)
     timeout = 250; // ~50 ms
     do {
       Delay1KTCYx(1); // 0.2 ms
+#ifdef OVMS_CANRXQUEUE
+      // the reply is detected by poll1, which now runs from the queue:
+      vehicle_rxq_process();
+#endif // OVMS_CANRXQUEUE
     } while (twizy_sdo.control == 0xff && --timeout);
 
     if (timeout != 0)
@@ -4495,6 +4503,13 @@ void high_isr(void)
 
       // Continue with normal processing:
 
+#ifdef OVMS_CANRXQUEUE
+#ifdef OVMS_CANSTATS
+      vehicle_canstat_rx(0, ((unsigned int)RXB0SIDL >>5) + ((unsigned int)RXB0SIDH <<3),
+              RXB0DLC & 0x0F);
+#endif // OVMS_CANSTATS
+      VEHICLE_RXQ_PUT(0, 0x01);
+#else // OVMS_CANRXQUEUE
       can_id = ((unsigned int)RXB0SIDL >>5)
              + ((unsigned int)RXB0SIDH <<3);
       can_filter = RXB0CON & 0x01;
@@ -4510,12 +4525,27 @@ void high_isr(void)
       RXB0CONbits.RXFUL = 0; // All bytes read, Clear flag
       PIR3bits.RXB0IF = 0;   // reset interrupt flag
 
+#ifdef OVMS_CANSTATS
+      vehicle_canstat_rx(0, can_id, can_datalength);
+#endif // OVMS_CANSTATS
+
+#ifdef OVMS_CANCACHE
+      if (!vehicle_cancache_check())
+#endif // OVMS_CANCACHE
       vehicle_twizy_poll0();
+#endif // OVMS_CANRXQUEUE
     }
     
     // Check RX buffer 1:
     if (RXB1CONbits.RXFUL)
     {
+#ifdef OVMS_CANRXQUEUE
+#ifdef OVMS_CANSTATS
+      vehicle_canstat_rx(1, ((unsigned int)RXB1SIDL >>5) + ((unsigned int)RXB1SIDH <<3),
+              RXB1DLC & 0x0F);
+#endif // OVMS_CANSTATS
+      VEHICLE_RXQ_PUT(1, 0x07);
+#else // OVMS_CANRXQUEUE
       can_id = ((unsigned int)RXB1SIDL >>5)
              + ((unsigned int)RXB1SIDH <<3);
       can_filter = RXB1CON & 0x07;
@@ -4530,8 +4560,16 @@ void high_isr(void)
       can_databuffer[7] = RXB1D7;
       RXB1CONbits.RXFUL = 0;        // All bytes read, Clear flag
       PIR3bits.RXB1IF = 0;          // reset interrupt flag
+
+#ifdef OVMS_CANSTATS
+      vehicle_canstat_rx(1, can_id, can_datalength);
+#endif // OVMS_CANSTATS
       
+#ifdef OVMS_CANCACHE
+      if (!vehicle_cancache_check())
+#endif // OVMS_CANCACHE
       vehicle_twizy_poll1();
+#endif // OVMS_CANRXQUEUE
     }
 
   } while (PIR3bits.RXB0IF || PIR3bits.RXB1IF);
@@ -4553,7 +4591,9 @@ void high_isr(void)
 // Poll buffer 0:
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_twizy_poll0(void)
 {
@@ -5221,7 +5261,9 @@ BOOL vehicle_twizy_poll1(void)
   return TRUE;
 }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 /***************************************************************
@@ -5231,13 +5273,11 @@ BOOL vehicle_twizy_poll1(void)
 
 void vehicle_twizy_req_notification(UINT8 notify)
 {
-  par_read(PARAM_NOTIFIES);
-  
-  if (strchr(par_value, 'S') &&
+  if ((par_notifies & PAR_NOTIFY_SMS) &&
           ((sys_features[FEATURE_CARBITS] & FEATURE_CB_SOUT_SMS)==0))
     twizy_notify_sms |= notify;
   
-  if (strchr(par_value, 'I'))
+  if (par_notifies & PAR_NOTIFY_IP)
     twizy_notify_msg |= notify;
 }
 
@@ -8538,24 +8578,22 @@ BOOL vehicle_twizy_fn_smshandler(BOOL premsg, char *caller, char *command, char
 {
   // called to extend/replace standard command: framework did auth check for us
 
-  UINT8 k;
+  signed char k;
 
   // Command parsing...
-  for (k = 0; vehicle_twizy_sms_cmdtable[k][0] != 0; k++)
+  k = net_sms_findcmd((char const rom far*)vehicle_twizy_sms_cmdtable, command);
+  if (k >= 0)
   {
-    if (starts_with(command, (char const rom far*)vehicle_twizy_sms_cmdtable[k] + 1))
-    {
-      // Call sms handler:
-      k = (*vehicle_twizy_sms_hfntable[k])(premsg, caller, command, arguments);
+    // Call sms handler:
+    k = (*vehicle_twizy_sms_hfntable[k])(premsg, caller, command, arguments);
 
-      if ((premsg) && (k))
-      {
-        // we're in charge + handled it; finish SMS:
-        net_send_sms_finish();
-      }
-
-      return k;
+    if ((premsg) && (k))
+    {
+      // we're in charge + handled it; finish SMS:
+      net_send_sms_finish();
     }
+
+    return k;
   }
 
   return FALSE; // no vehicle command
@@ -8565,29 +8603,27 @@ BOOL vehicle_twizy_fn_smsextensions(char *caller, char *command, char *arguments
 {
   // called for specific command: we need to do the auth check
 
-  UINT8 k;
+  signed char k;
 
   // Command parsing...
-  for (k = 0; vehicle_twizy_sms_cmdtable[k][0] != 0; k++)
+  k = net_sms_findcmd((char const rom far*)vehicle_twizy_sms_cmdtable, command);
+  if (k >= 0)
   {
-    if (starts_with(command, (char const rom far*)vehicle_twizy_sms_cmdtable[k] + 1))
-    {
-      // we need to check the caller authorization:
-      arguments = net_sms_initargs(arguments);
-      if (!net_sms_checkauth(vehicle_twizy_sms_cmdtable[k][0], caller, &arguments))
-        return FALSE; // failed
+    // we need to check the caller authorization:
+    arguments = net_sms_initargs(arguments);
+    if (!net_sms_checkauth(vehicle_twizy_sms_cmdtable[k][0], caller, &arguments))
+      return FALSE; // failed
 
-      // Call sms handler:
-      k = (*vehicle_twizy_sms_hfntable[k])(TRUE, caller, command, arguments);
-
-      if (k)
-      {
-        // we're in charge + handled it; finish SMS:
-        net_send_sms_finish();
-      }
+    // Call sms handler:
+    k = (*vehicle_twizy_sms_hfntable[k])(TRUE, caller, command, arguments);
 
-      return k;
+    if (k)
+    {
+      // we're in charge + handled it; finish SMS:
+      net_send_sms_finish();
     }
+
+    return k;
   }
 
   return FALSE; // no vehicle command
@@ -8622,6 +8658,14 @@ BOOL vehicle_twizy_help_sms(BOOL premsg, char *caller, char *command, char *argu
 }
 #endif // OVMS_TWIZY_HELP
 
+#ifdef OVMS_CANCACHE
+// IDs decoded only on payload change (see vehicle_cancache_check).
+// Not cached: 0x155 (power/distance integration), 0x55_ (sensor group
+// window), 0x597 (status edges), 0x599 (accel stats), 0x59B (pedal avg),
+// 0x081/0x581 (SDO/error handling).
+rom unsigned int vehicle_twizy_cancache[] = { 0x196, 0x424, 0x59E, 0x5D7, 0x69F, 0 };
+#endif // OVMS_CANCACHE
+
 ////////////////////////////////////////////////////////////////////////
 // vehicle_twizy_initialise()
 // This function is an entry point from the main() program loop, and
@@ -8839,7 +8883,8 @@ BOOL vehicle_twizy_initialise(void)
   vehicle_version = vehicle_twizy_version;
   can_capabilities = vehicle_twizy_capabilities;
 
-#ifndef OVMS_CUSTOM_CAN_ISR
+#if !defined(OVMS_CUSTOM_CAN_ISR) || defined(OVMS_CANRXQUEUE)
+  // (custom ISR with OVMS_CANRXQUEUE: handlers run from vehicle_rxq_process)
   vehicle_fn_poll0 = &vehicle_twizy_poll0;
   vehicle_fn_poll1 = &vehicle_twizy_poll1;
 #endif
@@ -8852,6 +8897,10 @@ BOOL vehicle_twizy_initialise(void)
   vehicle_fn_smsextensions = &vehicle_twizy_fn_smsextensions;
   vehicle_fn_commandhandler = &vehicle_twizy_fn_commandhandler;
 
+#ifdef OVMS_CANCACHE
+  vehicle_cancache_setids(vehicle_twizy_cancache);
+#endif // OVMS_CANCACHE
+
   net_fnbits |= NET_FN_INTERNALGPS;   // Require internal GPS
   net_fnbits |= NET_FN_12VMONITOR;    // Require 12v monitor
   net_fnbits |= NET_FN_SOCMONITOR;    // Require SOC monitor
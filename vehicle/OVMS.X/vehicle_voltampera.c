@@ -229,7 +229,9 @@ BOOL vehicle_voltampera_ticker1(void)
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_voltampera_poll0(void)
   {
@@ -384,7 +386,9 @@ BOOL vehicle_voltampera_poll1(void)
   return TRUE;
   }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 BOOL vehicle_voltampera_fn_commandhandler(BOOL msgmode, int cmd, char *msg)
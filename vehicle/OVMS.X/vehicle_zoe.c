@@ -131,7 +131,9 @@ UINT8 zoe_busactive;
 //
 
 // ISR optimization, see http://www.xargs.com/pic/c18-isr-optim.pdf
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata high_isr_tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 BOOL vehicle_zoe_poll0(void) {
 
@@ -160,7 +162,9 @@ BOOL vehicle_zoe_poll0(void) {
   return TRUE;
 }
 
+#ifndef OVMS_CANRXQUEUE
 #pragma tmpdata
+#endif //#ifndef OVMS_CANRXQUEUE
 
 
 ////////////////////////////////////////////////////////////////////////////////